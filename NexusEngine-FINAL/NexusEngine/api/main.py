@@ -7,7 +7,7 @@ from dotenv import load_dotenv
 from api.routers.routes    import engine_router,compute_router,hash_router,metrics_router,health_router
 from api.routers.dashboard import ui_router
 from api.middleware.middleware import RequestIDMiddleware,LoggingMiddleware,RateLimitMiddleware,CORSMiddleware
-from api.services.services import engine_service
+from api.services.services import engine_service, compute_service
 
 load_dotenv()
 logging.basicConfig(level=logging.INFO,format="%(asctime)s [%(levelname)s] %(name)s — %(message)s")
@@ -21,7 +21,9 @@ async def lifespan(app):
     logger.info("  Swagger   : http://localhost:8000/docs")
     logger.info("  Módulos   : binary|matrix|quantum|hash|sort|prime|sequence|stats")
     logger.info("="*58)
+    compute_service.prime_table_load()
     yield
+    compute_service.prime_table_save()
     engine_service.stop()
 
 app=FastAPI(
@@ -37,9 +39,11 @@ app=FastAPI(
 | **Matrix** | 10 | zeros, ones, identity, random, hilbert, magic, vandermonde, toeplitz + análise |
 | **Quantum** | 12 | H, X, Y, Z, S, T, Sdg, CNOT, CZ, SWAP, Rx, Ry, Rz + vetor de estado |
 | **Hash** | 10 | md5, sha1, sha224, sha256, sha384, sha512, sha3_256, sha3_512, blake2b, blake2s |
-| **Sort** | 8 | bubble, insertion, selection, merge, quick, heap, shell, counting + benchmark |
+| **Sort** | 11 | bubble, insertion, selection, merge, quick, heap, shell, counting, native, sample (paralelo), auto + argsort/kv + benchmark |
 | **Prime** | 5 | is_prime, sieve, factorize, goldbach, nth_prime |
+| **NumberTheory** | 4 | modpow, modinv, crt, dlog (escalar e em lote) |
 | **Sequence** | 5 | fibonacci, collatz, pascal, lucas, tribonacci |
+| **Binomial** | 2 | nck, row (exato ou mod m; lote e triângulo em streaming) |
 | **Statistics** | 3 | analyze, correlation, histogram |
 """,
     version="3.0.0",lifespan=lifespan,docs_url="/docs",redoc_url="/redoc",
@@ -1,6 +1,6 @@
 """Schemas Pydantic v2 — NexusEngine Omega v3.0 | Autor: Emanuel Felipe"""
 from pydantic import BaseModel, Field, field_validator
-from typing import Optional, Dict, List, Any
+from typing import Optional, Dict, List, Any, Union, Annotated
 from datetime import datetime
 from enum import Enum
 
@@ -86,45 +86,267 @@ class HmacReq(BaseModel):
     key: str; data: str; algorithm: str="sha256"
 
 # ── Sort ─────────────────────────────────────────────────────────────────────
-SORT_ALGOS=["bubble","insertion","selection","merge","quick","heap","shell","counting"]
+SORT_ALGOS=["bubble","insertion","selection","merge","quick","heap","shell","counting","native","sample","auto"]
+SORT_DTYPES=["auto","int64","float64","float32"]
+SORT_MODES=["sort","argsort","kv"]
 class SortReq(BaseModel):
-    data: List[float] = Field(..., min_length=1, max_length=10_000)
+    data: List[Union[int,float]] = Field(..., min_length=1, max_length=10_000, description="Inteiros entram exatos (até 2^63)")
     algorithm: str = Field("merge")
+    workers: int = Field(0, ge=0, le=256, description="Threads do sample sort (0 = pool do engine)")
+    dtype: str = Field("auto", description=f"Uma de: {SORT_DTYPES} (auto = int64 se todos inteiros)")
+    mode: str = Field("sort", description=f"Uma de: {SORT_MODES} (argsort/kv só em native/sample)")
+    stable: bool = Field(False, description="Ordenação estável no backend native")
+    nan_position: str = Field("last", pattern="^(first|last)$")
+    payload: Optional[Dict[str,List[Any]]] = Field(None, description="Colunas movidas junto com a chave (mode=kv)")
+    limit: int = Field(50, ge=1, le=10_000, description="Quantos elementos devolver")
+    instrument: bool = Field(True, description="False = kernels didáticos sem contadores (mede só o algoritmo)")
     @field_validator("algorithm")
     @classmethod
     def chk(cls,v):
         if v not in SORT_ALGOS: raise ValueError(f"Use: {SORT_ALGOS}")
         return v
+    @field_validator("dtype")
+    @classmethod
+    def chk_dtype(cls,v):
+        if v not in SORT_DTYPES: raise ValueError(f"Use: {SORT_DTYPES}")
+        return v
+    @field_validator("mode")
+    @classmethod
+    def chk_mode(cls,v):
+        if v not in SORT_MODES: raise ValueError(f"Use: {SORT_MODES}")
+        return v
+
+class ParallelSortReq(BaseModel):
+    data: Optional[List[Union[int,float]]] = Field(None, max_length=1_000_000)
+    size: int = Field(0, ge=0, le=50_000_000, description="Gera N inteiros aleatórios no servidor (admitido por NEXUS_MEMORY_MB)")
+    workers: int = Field(0, ge=0, le=256)
+
+SELECT_OPS=["topk","nth_element","partial_sort","multiselect"]
+class SelectReq(BaseModel):
+    operation: str = Field(..., description=f"Uma de: {SELECT_OPS}")
+    data: List[Union[int,float]] = Field(..., min_length=1, max_length=1_000_000)
+    k: int = Field(10, ge=0, description="Tamanho do top-k/partial_sort, ou rank do nth_element")
+    ranks: Optional[List[int]] = Field(None, max_length=1000, description="Ranks (0-based) do multiselect")
+    quantiles: Optional[List[float]] = Field(None, max_length=1000, description="Alternativa a ranks, em [0,1]")
+    largest: bool = True
+    dtype: str = Field("auto")
+    backend: str = Field("auto", pattern="^(auto|python|native)$")
+    workers: int = Field(0, ge=0, le=256)
+    @field_validator("operation")
+    @classmethod
+    def chk(cls,v):
+        if v not in SELECT_OPS: raise ValueError(f"Use: {SELECT_OPS}")
+        return v
+    @field_validator("quantiles")
+    @classmethod
+    def chk_q(cls,v):
+        if v and any(not 0<=q<=1 for q in v): raise ValueError("Quantis devem estar em [0,1]")
+        return v
+
+class SegmentedSortReq(BaseModel):
+    values: Optional[List[Union[int,float]]] = Field(None, max_length=2_000_000, description="Valores empacotados")
+    offsets: Optional[List[int]] = Field(None, max_length=1_000_001, description="Início de cada segmento + len(values)")
+    dtype: str = Field("auto")
+    workers: int = Field(0, ge=0, le=256)
+    generate_segments: int = Field(0, ge=0, le=10_000_000, description="Gera N segmentos aleatórios (teste de vazão)")
+    generate_max_len: int = Field(64, ge=1, le=100_000, description="generate_segments·generate_max_len <= 5e7")
+    limit: int = Field(1000, ge=0, le=2_000_000, description="Quantos valores devolver")
+    @field_validator("dtype")
+    @classmethod
+    def chk_dtype(cls,v):
+        if v not in SORT_DTYPES: raise ValueError(f"Use: {SORT_DTYPES}")
+        return v
+    @field_validator("generate_max_len")
+    @classmethod
+    def chk_gen(cls,v,info):
+        if info.data.get("generate_segments",0)*v>50_000_000:
+            raise ValueError("generate_segments·generate_max_len deve ser <= 5e7 (mesmo teto de /sort/parallel)")
+        return v
+
+class MergeReq(BaseModel):
+    runs: Optional[List[Annotated[List[float],Field(max_length=2_000_000)]]] = Field(None, max_length=100_000, description="Runs já ordenadas (inline)")
+    paths: Optional[List[str]] = Field(None, max_length=100_000, description="Runs ordenadas em NEXUS_DATA_DIR")
+    fmt: str = Field("binary", pattern="^(text|binary)$", description="Formato dos arquivos em paths")
+    dtype: str = Field("float64", pattern="^(int64|float64|float32)$")
+    dedup: bool = False
+    workers: int = Field(0, ge=0, le=256)
+    memory_mb: int = Field(0, ge=0, le=65536, description="0 = NEXUS_SORT_MEMORY_MB")
+    out_fmt: str = Field("binary", pattern="^(text|binary)$")
+    @field_validator("runs")
+    @classmethod
+    def chk_runs(cls,v):
+        if v is not None and sum(len(r) for r in v)>2_000_000:
+            raise ValueError("runs inline somam mais de 2e6 valores; use paths ou /sort/merge/stream")
+        return v
 
 class SortBenchmarkReq(BaseModel):
     data: List[float] = Field(..., min_length=2, max_length=500)
 
+BENCH_WORKLOADS=["uniform","sorted","reversed","organ_pipe","few_unique","zipf","nearly_sorted"]
+class SortBenchmarkSuiteReq(BaseModel):
+    algorithms: List[str] = Field(default_factory=lambda:list(SORT_ALGOS))
+    distributions: List[str] = Field(default_factory=lambda:list(BENCH_WORKLOADS))
+    sizes: List[int] = Field([1_000,10_000,100_000], min_length=1, max_length=8)
+    warmup: int = Field(1, ge=0, le=10)
+    repetitions: int = Field(5, ge=1, le=50)
+    time_cap_s: float = Field(5.0, gt=0, le=300, description="Teto por execução; estouro pula os tamanhos maiores")
+    seed: int = Field(42, ge=0, lt=2**64, description="Semente do gerador das cargas (np.random.default_rng)")
+    @field_validator("algorithms")
+    @classmethod
+    def chk(cls,v):
+        if not v or any(a not in SORT_ALGOS for a in v): raise ValueError(f"Use: {SORT_ALGOS}")
+        return v
+    @field_validator("distributions")
+    @classmethod
+    def chk_d(cls,v):
+        if not v or any(d not in BENCH_WORKLOADS for d in v): raise ValueError(f"Use: {BENCH_WORKLOADS}")
+        return v
+    @field_validator("sizes")
+    @classmethod
+    def chk_n(cls,v):
+        if any(not 1<=n<=10_000_000 for n in v): raise ValueError("Tamanhos devem estar em [1, 10_000_000]")
+        return v
+
 # ── Prime ─────────────────────────────────────────────────────────────────────
-PRIME_OPS=["is_prime","sieve","factorize","goldbach","nth_prime"]
+PRIME_OPS=["is_prime","sieve","factorize","goldbach","nth_prime","pi"]
 class PrimeReq(BaseModel):
     operation: str = Field(..., description=f"Uma de: {PRIME_OPS}")
     n: int = Field(97, ge=1)
-    limit: int = Field(1000, ge=2, le=1_000_000)
+    limit: int = Field(1000, ge=2, le=10_000_000_000, description="sieve: primos listados até 100000; count até limit")
+    rounds: int = Field(0, ge=0, le=64, description="is_prime acima de 2^64: bases extras de Miller-Rabin além do BPSW")
+    budget_ms: int = Field(5000, ge=1, le=600_000, description="factorize: prazo total; o que sobrar vem em unfactored")
     @field_validator("operation")
     @classmethod
     def chk(cls,v):
         if v not in PRIME_OPS: raise ValueError(f"Use: {PRIME_OPS}")
         return v
 
+class PrimeRangeReq(BaseModel):
+    lo: int = Field(..., ge=0, le=10**18)
+    hi: int = Field(..., ge=0, le=10**18)
+    cursor: Optional[int] = Field(None, ge=0, description="next_cursor da página anterior")
+    limit: int = Field(1_000_000, ge=1, le=100_000_000, description="Primos por página")
+    format: str = Field("ndjson", pattern="^(ndjson|delta)$")
+    workers: int = Field(0, ge=0, le=256)
+    @field_validator("hi")
+    @classmethod
+    def chk_hi(cls,v,info):
+        if v<info.data.get("lo",0): raise ValueError("hi deve ser >= lo")
+        return v
+
+class GoldbachReq(BaseModel):
+    lo: int = Field(4, ge=4, description="Início da janela devolvida em json/binary")
+    n: int = Field(..., ge=4, le=50_000_000, description="r(m) para todo m par em [lo, n]")
+    out: str = Field("summary", pattern="^(summary|json|binary)$", description="binary: uint32 little-endian por m par")
+    workers: int = Field(0, ge=0, le=256)
+    @field_validator("n")
+    @classmethod
+    def chk_n(cls,v,info):
+        if v<info.data.get("lo",4): raise ValueError("n deve ser >= lo")
+        return v
+
+class PrimeTableReq(BaseModel):
+    limit: int = Field(0, ge=0, le=10**12, description="Cresce a tabela até aqui antes de gravar (limitado por NEXUS_PRIME_TABLE_MAX)")
+
+class PrimeCountReq(BaseModel):
+    lo: int = Field(0, ge=0, le=10**18)
+    hi: int = Field(..., ge=0, le=10**18)
+    workers: int = Field(0, ge=0, le=256)
+    scaling: bool = Field(False, description="Repete com 1, 2, 4… threads e relata speedup")
+    @field_validator("hi")
+    @classmethod
+    def chk_hi(cls,v,info):
+        if v<info.data.get("lo",0): raise ValueError("hi deve ser >= lo")
+        return v
+
+# ── Number theory ─────────────────────────────────────────────────────────────
+NT_OPS=["modpow","modinv","crt","dlog"]
+class NumberTheoryReq(BaseModel):
+    operation: str = Field(..., description=f"Uma de: {NT_OPS}")
+    a: int = Field(0, description="modpow/modinv: base · dlog: g")
+    b: int = Field(0, description="modpow: expoente (negativo usa o inverso) · dlog: h")
+    m: int = Field(1, ge=1, description="Módulo (inteiro de qualquer tamanho)")
+    residues: Optional[List[int]] = Field(None, max_length=10_000, description="crt: r_i")
+    moduli: Optional[List[int]] = Field(None, max_length=10_000, description="crt: m_i (não precisam ser coprimos)")
+    @field_validator("operation")
+    @classmethod
+    def chk(cls,v):
+        if v not in NT_OPS: raise ValueError(f"Use: {NT_OPS}")
+        return v
+
 # ── Sequence ───────────────────────────────────────────────────────────────────
 SEQ_OPS=["fibonacci","collatz","pascal","lucas","tribonacci"]
 class SequenceReq(BaseModel):
     operation: str = Field(..., description=f"Uma de: {SEQ_OPS}")
-    n: int = Field(20, ge=1, le=10_000)
+    n: int = Field(20, ge=1, le=10**18, description="fibonacci/lucas: até 2e7 sem mod, 1e18 com mod")
+    mod: Optional[int] = Field(None, ge=1, description="fibonacci/lucas: termos mod m")
+    format: str = Field("dec", pattern="^(dec|hex)$", description="Texto do último termo quando grande")
     @field_validator("operation")
     @classmethod
     def chk(cls,v):
         if v not in SEQ_OPS: raise ValueError(f"Use: {SEQ_OPS}")
         return v
 
+class RecurrenceReq(BaseModel):
+    preset: Optional[str] = Field(None, description="fibonacci, lucas, tribonacci, pell, jacobsthal, padovan, perrin")
+    coeffs: Optional[List[int]] = Field(None, max_length=2000, description="c1..ck em a(n) = c1·a(n-1) + … + ck·a(n-k)")
+    init: Optional[List[int]] = Field(None, max_length=2000, description="a(0)..a(k-1)")
+    n: Optional[int] = Field(None, ge=0, le=10**18, description="Termo a(n) (Kitamasa, O(M(k)·log n))")
+    lo: Optional[int] = Field(None, ge=0, le=10**18, description="Faixa a(lo)..a(hi)")
+    hi: Optional[int] = Field(None, ge=0, le=10**18)
+    mod: Optional[int] = Field(None, ge=1)
+    format: str = Field("dec", pattern="^(dec|hex)$")
+
+class CollatzRangeReq(BaseModel):
+    a: int = Field(1, ge=1, lt=2**62)
+    b: int = Field(..., ge=1, lt=2**62, description="Até 2e7 inícios por chamada")
+    workers: int = Field(0, ge=0, le=256)
+    @field_validator("b")
+    @classmethod
+    def chk_b(cls,v,info):
+        if v<info.data.get("a",1): raise ValueError("b deve ser >= a")
+        return v
+
+class InferReq(BaseModel):
+    terms: List[int] = Field(..., min_length=1, max_length=5000)
+    mod: Optional[int] = Field(None, ge=2, description="Primo: Berlekamp-Massey sobre Z/p (sem mod: racionais, até 1000 termos)")
+
+class SequenceStreamReq(BaseModel):
+    operation: str = Field("fibonacci", description="Preset (fibonacci, lucas, tribonacci, pell…), recurrence ou collatz")
+    pos: int = Field(0, ge=0, le=10**18, description="Primeiro termo; o salto custa O(log pos)")
+    count: int = Field(1000, ge=0, le=1_000_000)
+    coeffs: Optional[List[int]] = Field(None, max_length=2000, description="recurrence: c1..ck")
+    init: Optional[List[int]] = Field(None, max_length=2000, description="recurrence: a(0)..a(k-1)")
+    mod: Optional[int] = Field(None, ge=1)
+    seed: Optional[int] = Field(None, ge=1, lt=2**1024, description="collatz: valor inicial")
+    cursor: Optional[str] = Field(None, max_length=1_000_000, description="next_cursor de uma página anterior (substitui os demais campos)")
+    chunk: int = Field(4096, ge=1, le=65536, description="Termos por linha NDJSON / bloco binário")
+    format: str = Field("ndjson", pattern="^(ndjson|binary)$", description="binary: uint64 little-endian, exige mod <= 2^64")
+
+class BinomialReq(BaseModel):
+    operation: str = Field("nck", pattern="^(nck|row)$")
+    n: int = Field(..., ge=0, lt=2**64, description="Exato até 1e6; com mod até 2^64-1")
+    k: int = Field(0, ge=0, lt=2**64, description="nck: C(n, k)")
+    lo: int = Field(0, ge=0, lt=2**64, description="row: C(n, lo..hi)")
+    hi: Optional[int] = Field(None, ge=0, lt=2**64, description="row: padrão n")
+    mod: Optional[int] = Field(None, ge=1, lt=2**62, description="m fatorado (Lucas generalizado + CRT); potências p^e com e > 1 até 2^22, primos de qualquer tamanho")
+    format: str = Field("dec", pattern="^(dec|hex)$")
+
+class TriangleReq(BaseModel):
+    r0: int = Field(0, ge=0, le=10**6, description="Primeira linha")
+    r1: int = Field(..., ge=0, le=10**6, description="Última linha (exato até 2000)")
+    mod: Optional[int] = Field(None, ge=1, lt=2**62)
+    workers: int = Field(0, ge=0, le=256)
+    @field_validator("r1")
+    @classmethod
+    def chk_r1(cls,v,info):
+        if v<info.data.get("r0",0): raise ValueError("r1 deve ser >= r0")
+        return v
+
 # ── Statistics ────────────────────────────────────────────────────────────────
 class StatsReq(BaseModel):
-    data: List[float] = Field(..., min_length=2, max_length=100_000)
+    data: List[float] = Field(..., min_length=2, max_length=1_000_000, description="Até 1e6 valores; acima disso, /stats/stream")
+    workers: int = Field(0, ge=0, le=256)
 
 class CorrelationReq(BaseModel):
     x: List[float]; y: List[float]
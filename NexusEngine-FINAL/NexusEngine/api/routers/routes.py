@@ -1,7 +1,9 @@
 """Routes — NexusEngine Omega v3.0 | Autor: Emanuel Felipe"""
 import time, logging, threading
 from datetime import datetime
-from fastapi import APIRouter, HTTPException, BackgroundTasks
+from fastapi import APIRouter, HTTPException, BackgroundTasks, Request, Query
+from fastapi.responses import StreamingResponse, Response
+from typing import Optional, List
 from ..models.schemas import *
 from ..services.services import engine_service, compute_service, metrics_service
 
@@ -77,39 +79,269 @@ async def quantum(req: QuantumReq):
     return {**r,"timestamp":datetime.utcnow().isoformat()}
 
 # ── Compute / Sort ────────────────────────────────────────────────────────────
-@compute_router.post("/sort", summary="Ordenar lista (8 algoritmos)")
+@compute_router.post("/sort", summary="Ordenar lista (11 algoritmos incl. auto, sort/argsort/kv)")
 async def sort(req: SortReq):
-    t0=_t(); r=compute_service.sort(req.data,req.algorithm)
+    t0=_t(); r=compute_service.sort(req.data,req.algorithm,req.workers,dtype=req.dtype,mode=req.mode,
+                                    stable=req.stable,nan_position=req.nan_position,
+                                    payload=req.payload,limit=req.limit,instrument=req.instrument)
     if _err(r): raise HTTPException(400,r["error"])
     metrics_service.record(_lat(t0),True,"sort")
     return {**r,"timestamp":datetime.utcnow().isoformat()}
 
+@compute_router.post("/sort/parallel", summary="Sample sort paralelo com tempos por fase")
+def sort_parallel(req: ParallelSortReq):
+    t0=_t(); r=compute_service.sort_parallel(req.data,req.size,req.workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sort/segmented", summary="Ordena muitos segmentos independentes numa chamada")
+def sort_segmented(req: SegmentedSortReq):
+    t0=_t(); r=compute_service.sort_segmented(req.values,req.offsets,req.dtype,req.workers,
+                                              req.generate_segments,req.generate_max_len,req.limit)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sort/select", summary="Top-k, nth_element, partial_sort e multiselect")
+def sort_select(req: SelectReq):
+    t0=_t(); r=compute_service.sort_select(req.operation,req.data,k=req.k,ranks=req.ranks,
+                                           quantiles=req.quantiles,largest=req.largest,dtype=req.dtype,
+                                           backend=req.backend,workers=req.workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sort/topk/stream", summary="Top-k sobre corpo em streaming (memória limitada)")
+async def sort_topk_stream(req: Request, k: int=Query(100,ge=1,le=1_000_000), largest: bool=True,
+                           fmt: str=Query("text",pattern="^(text|binary)$"),
+                           dtype: str=Query("float64",pattern="^(int64|float64|float32)$")):
+    t0=_t(); r=await compute_service.sort_topk_stream(req.stream(),k,largest,fmt,dtype)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sort/external", summary="Merge sort externo (entrada e saída em streaming)")
+async def sort_external(req: Request, fmt: str=Query("binary",pattern="^(text|binary)$"),
+                        dtype: str=Query("float64",pattern="^(int64|float64|float32)$"),
+                        out_fmt: str=Query("binary",pattern="^(text|binary)$"),
+                        memory_mb: int=Query(0,ge=0,le=65536,description="0 = NEXUS_SORT_MEMORY_MB"),
+                        path: Optional[str]=Query(None,description="Dataset em NEXUS_DATA_DIR (ignora o corpo)")):
+    t0=_t(); r,gen=await compute_service.sort_external(None if path else req.stream(),fmt,dtype,
+                                                       memory_mb,path,out_fmt)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    m=r["metrics"]
+    return StreamingResponse(gen,media_type="application/octet-stream" if out_fmt=="binary" else "text/plain",
+                             headers={"X-Sort-Job":r["job"],"X-Sort-Count":str(r["input_size"]),
+                                      "X-Sort-Runs":str(m["runs"]),"X-Sort-Dtype":dtype})
+
+@compute_router.get("/sort/external/{job}", summary="Métricas por fase de um sort externo")
+async def sort_external_job(job: str):
+    r=compute_service.sort_external_job(job)
+    if r is None: raise HTTPException(404,"Job não encontrado")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+def _merge_response(r,gen,out_fmt,dtype):
+    return StreamingResponse(gen,media_type="application/octet-stream" if out_fmt=="binary" else "text/plain",
+                             headers={"X-Sort-Job":r["job"],"X-Sort-Runs":str(r["runs"]),"X-Sort-Dtype":dtype})
+
+@compute_router.post("/sort/merge", summary="Merge em K vias de runs já ordenadas (saída em streaming)")
+def sort_merge(req: MergeReq):
+    t0=_t(); r,gen=compute_service.sort_merge(req.runs,req.paths,req.fmt,req.dtype,req.dedup,
+                                             req.workers,req.memory_mb,req.out_fmt)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    return _merge_response(r,gen,req.out_fmt,req.dtype)
+
+@compute_router.post("/sort/merge/stream", summary="Merge em K vias de runs concatenadas no corpo")
+async def sort_merge_stream(req: Request, lengths: str=Query(...,pattern=r"^\d+(,\d+)*$",description="Tamanho de cada run, em ordem"),
+                            fmt: str=Query("binary",pattern="^(text|binary)$"),
+                            dtype: str=Query("float64",pattern="^(int64|float64|float32)$"),
+                            out_fmt: str=Query("binary",pattern="^(text|binary)$"),
+                            dedup: bool=False, workers: int=Query(0,ge=0,le=256),
+                            memory_mb: int=Query(0,ge=0,le=65536,description="0 = NEXUS_SORT_MEMORY_MB")):
+    t0=_t(); r,gen=await compute_service.sort_merge_stream(req.stream(),[int(x) for x in lengths.split(",")],
+                                                          fmt,dtype,dedup,workers,memory_mb,out_fmt)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sort")
+    return _merge_response(r,gen,out_fmt,dtype)
+
+@compute_router.get("/sort/merge/{job}", summary="Métricas de um merge em K vias")
+async def sort_merge_job(job: str): return await sort_external_job(job)
+
 @compute_router.post("/sort/benchmark", summary="Benchmark de todos os algoritmos")
 async def sort_benchmark(req: SortBenchmarkReq):
     t0=_t(); r=compute_service.sort_benchmark(req.data)
     metrics_service.record(_lat(t0),True,"sort")
     return {**r,"timestamp":datetime.utcnow().isoformat()}
 
+@compute_router.post("/sort/benchmark/suite", summary="Benchmark rigoroso: cargas geradas, repetições e processos isolados")
+def sort_benchmark_suite(req: SortBenchmarkSuiteReq):
+    t0=_t(); r=compute_service.sort_benchmark_suite(**req.model_dump())
+    metrics_service.record(_lat(t0),True,"sort")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
 # ── Compute / Prime ───────────────────────────────────────────────────────────
 @compute_router.post("/prime", summary="Operações com números primos")
-async def prime(req: PrimeReq):
-    t0=_t(); r=compute_service.prime(req.operation,req.n,req.limit)
+def prime(req: PrimeReq):
+    t0=_t(); r=compute_service.prime(req.operation,req.n,req.limit,req.rounds,req.budget_ms)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"prime")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/prime/range", summary="Primos em [lo, hi] em streaming NDJSON, paginados por cursor")
+def prime_range(req: PrimeRangeReq):
+    t0=_t(); r,gen=compute_service.prime_range(req.lo,req.hi,req.cursor,req.limit,req.format,req.workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"prime")
+    return StreamingResponse(gen,media_type="application/x-ndjson")
+
+@compute_router.post("/prime/batch", summary="is_prime/factorize em lote sobre inteiros uint64 (resultado empacotado)")
+async def prime_batch(req: Request, op: str=Query("is_prime",pattern="^(is_prime|factorize)$"),
+                      fmt: str=Query("binary",pattern="^(text|binary)$"),
+                      out: str=Query("binary",pattern="^(binary|json)$"), workers: int=Query(0,ge=0,le=256)):
+    t0=_t(); r,packed=await compute_service.prime_batch(req.stream(),op,fmt,workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"prime")
+    if out=="json":
+        body={"is_prime":packed[1].tolist()} if op=="is_prime" else {"offsets":packed[0].tolist(),"factors":packed[1].tolist()}
+        return {**r,**body,"timestamp":datetime.utcnow().isoformat()}
+    data=packed[0].tobytes() if op=="is_prime" else packed[0].tobytes()+packed[1].tobytes()
+    return Response(data,media_type="application/octet-stream",
+                    headers={"X-Count":str(r["count"]),**({"X-Primes":str(r["primes"])} if op=="is_prime" else
+                             {"X-Factors":str(r["factor_count"]),"X-Incomplete":",".join(map(str,r["incomplete"][:1000]))})})
+
+@compute_router.post("/prime/goldbach", summary="Partições de Goldbach r(n) para todo n par até N (convolução por FFT)")
+def prime_goldbach(req: GoldbachReq):
+    t0=_t(); r,w=compute_service.prime_goldbach(req.n,req.lo,req.workers)
     if _err(r): raise HTTPException(400,r["error"])
     metrics_service.record(_lat(t0),True,"prime")
+    if req.out=="binary":
+        return Response(w.tobytes(),media_type="application/octet-stream",headers={"X-Lo":str(r["lo"]),"X-Count":str(len(w))})
+    return {**r,**({"counts":w.tolist()} if req.out=="json" else {}),"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.get("/prime/table", summary="Estado da tabela de primos do processo")
+def prime_table():
+    return {**compute_service.prime_table(),"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/prime/table", summary="Cresce a tabela de primos e grava em NEXUS_PRIME_TABLE_FILE")
+def prime_table_save(req: PrimeTableReq):
+    t0=_t(); r=compute_service.prime_table_save(req.limit)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"prime")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/prime/count", summary="Contagem de primos em [lo, hi] com crivo segmentado paralelo")
+def prime_count(req: PrimeCountReq):
+    t0=_t(); r=compute_service.prime_count(req.lo,req.hi,req.workers,req.scaling)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"prime")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+# ── Compute / Number theory ─────────────────────────────────────────────────────
+@compute_router.post("/nt", summary="Aritmética modular: modpow, modinv, CRT, log discreto (inteiros grandes)")
+def number_theory(req: NumberTheoryReq):
+    t0=_t(); r=compute_service.number_theory(req.operation,req.a,req.b,req.m,req.residues,req.moduli)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"nt")
     return {**r,"timestamp":datetime.utcnow().isoformat()}
 
+@compute_router.post("/nt/batch", summary="modpow/modinv/crt em lote sobre registros uint64 (resultado empacotado)")
+async def number_theory_batch(req: Request, op: str=Query("modpow",pattern="^(modpow|modinv|crt)$"),
+                              fmt: str=Query("binary",pattern="^(text|binary)$"),
+                              out: str=Query("binary",pattern="^(binary|json)$"),
+                              mod: Optional[int]=Query(None,ge=1,lt=2**64,description="Módulo comum (sai dos registros)"),
+                              moduli: Optional[List[int]]=Query(None,description="crt: módulos coprimos, um por coluna"),
+                              workers: int=Query(0,ge=0,le=256)):
+    t0=_t(); r,packed=await compute_service.number_theory_batch(req.stream(),op,fmt,mod,moduli,workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"nt")
+    if out=="json":
+        return {**r,"results":packed[0].tolist(),**({"invertible":packed[1].tolist()} if packed[1] is not None else {}),
+                "timestamp":datetime.utcnow().isoformat()}
+    return Response(packed[0].tobytes(),media_type="application/octet-stream",
+                    headers={"X-Count":str(r["count"]),**({"X-Failed":str(r["failed"])} if "failed" in r else {})})
+
 # ── Compute / Sequence ────────────────────────────────────────────────────────
 @compute_router.post("/sequence", summary="Sequências numéricas (Fibonacci, Collatz, Pascal...)")
-async def sequence(req: SequenceReq):
-    t0=_t(); r=compute_service.sequence(req.operation,req.n)
+def sequence(req: SequenceReq):
+    t0=_t(); r=compute_service.sequence(req.operation,req.n,req.mod,req.format)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sequence/recurrence", summary="Recorrência linear genérica: a(n) por Kitamasa, faixas, mod e presets")
+def recurrence(req: RecurrenceReq):
+    t0=_t(); r=compute_service.recurrence(coeffs=req.coeffs,init=req.init,preset=req.preset,n=req.n,
+                                          lo=req.lo,hi=req.hi,mod=req.mod,fmt=req.format)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sequence/infer", summary="Infere a menor recorrência linear dos termos (Berlekamp-Massey)")
+def recurrence_infer(req: InferReq):
+    t0=_t(); r=compute_service.recurrence_infer(req.terms,req.mod)
     if _err(r): raise HTTPException(400,r["error"])
     metrics_service.record(_lat(t0),True,"sequence")
     return {**r,"timestamp":datetime.utcnow().isoformat()}
 
+@compute_router.post("/sequence/collatz", summary="Collatz em [a, b]: tempo total de parada, excursão máxima e recordistas")
+def collatz_range(req: CollatzRangeReq):
+    t0=_t(); r=compute_service.collatz_range(req.a,req.b,req.workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/sequence/stream", summary="Termos de uma sequência em streaming (NDJSON ou uint64), paginados por cursor")
+def sequence_stream(req: SequenceStreamReq):
+    t0=_t(); r,gen=compute_service.sequence_stream(req.operation,req.pos,req.count,req.coeffs,req.init,req.mod,
+                                                   req.seed,req.cursor,req.chunk,req.format)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    if req.format=="binary":
+        return StreamingResponse(gen,media_type="application/octet-stream",
+                                 headers={"X-Pos":str(r["pos"]),"X-Count":str(r["count"]),"X-Next-Cursor":r["next_cursor"]})
+    return StreamingResponse(gen,media_type="application/x-ndjson")
+
+@compute_router.post("/binomial", summary="C(n, k) e linhas do triângulo, exatos ou mod m (Lucas generalizado + CRT)")
+def binomial(req: BinomialReq):
+    t0=_t(); r=compute_service.binomial(req.operation,req.n,req.k,req.lo,req.hi,req.mod,req.format)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/binomial/batch", summary="C(n, k) mod m em lote sobre pares (n, k) uint64 (resultado empacotado)")
+async def binomial_batch(req: Request, mod: int=Query(...,ge=1,lt=2**62),
+                         fmt: str=Query("binary",pattern="^(text|binary)$"),
+                         out: str=Query("binary",pattern="^(binary|json)$"),
+                         workers: int=Query(0,ge=0,le=256)):
+    t0=_t(); r,packed=await compute_service.binomial_batch(req.stream(),mod,fmt,workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    if out=="json": return {**r,"results":packed.tolist(),"timestamp":datetime.utcnow().isoformat()}
+    return Response(packed.tobytes(),media_type="application/octet-stream",headers={"X-Count":str(r["count"])})
+
+@compute_router.post("/binomial/triangle", summary="Linhas r0..r1 do triângulo de Pascal em streaming NDJSON")
+def binomial_triangle(req: TriangleReq):
+    t0=_t(); r,gen=compute_service.binomial_triangle(req.r0,req.r1,req.mod,req.workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"sequence")
+    return StreamingResponse(gen,media_type="application/x-ndjson")
+
 # ── Compute / Statistics ───────────────────────────────────────────────────────
 @compute_router.post("/stats", summary="Análise estatística de dataset")
-async def stats(req: StatsReq):
-    t0=_t(); r=compute_service.stats_analyze(req.data)
+def stats(req: StatsReq):
+    t0=_t(); r=compute_service.stats_analyze(req.data,req.workers)
+    if _err(r): raise HTTPException(400,r["error"])
+    metrics_service.record(_lat(t0),True,"stats")
+    return {**r,"timestamp":datetime.utcnow().isoformat()}
+
+@compute_router.post("/stats/stream", summary="Análise estatística sobre corpo em streaming (texto ou binário)")
+async def stats_stream(req: Request, fmt: str=Query("binary",pattern="^(text|binary)$"),
+                       dtype: str=Query("float64",pattern="^(int64|float64|float32)$"),
+                       workers: int=Query(0,ge=0,le=256)):
+    t0=_t(); r=await compute_service.stats_stream(req.stream(),fmt,dtype,workers)
     if _err(r): raise HTTPException(400,r["error"])
     metrics_service.record(_lat(t0),True,"stats")
     return {**r,"timestamp":datetime.utcnow().isoformat()}
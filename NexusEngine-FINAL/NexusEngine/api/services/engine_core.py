@@ -8,18 +8,29 @@ Módulos:
   QuantumSimulator  — vetor de estado completo, 12 portas quânticas
   HashEngine        — 8 algoritmos criptográficos
   SortEngine        — 8 algoritmos de ordenação com telemetria
+  PrimeTable        — crivo segmentado com roda mod 30, cache do processo (persistível via mmap)
   PrimeEngine       — crivos, teste de primalidade, fatoração
+  NumberTheoryEngine — modpow, modinv, CRT e log discreto (escalar e em lote)
   CompressionEngine — RLE e estatísticas de compressão
   FibEngine         — Fibonacci e sequências numéricas
+  BinomialEngine    — C(n, k) exato ou mod m (Lucas generalizado + CRT)
   MetricsCollector  — latência real, CPU, memória
+  WorkerPool        — pool de threads compartilhado pelos kernels paralelos
+  MemoryBudget      — admissão de jobs por orçamento de memória
 """
 
-import time, math, random, hashlib, threading, struct, statistics
-from collections import deque
+import os, time, math, random, hashlib, threading, struct, statistics, tempfile, shutil, weakref
+import ast, inspect, textwrap, decimal, json, base64
+from collections import deque, Counter, OrderedDict
+from fractions import Fraction
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
 from typing import List, Dict, Optional, Tuple, Any
 from datetime import datetime
 
 import numpy as np
+try: import gmpy2                      # opcional: aritmética GMP para inteiros grandes
+except ImportError: gmpy2=None
 
 
 # ══════════════════════════════════════════════════════════════════════════════
@@ -289,96 +300,448 @@ class HashEngine:
 
 
 # ══════════════════════════════════════════════════════════════════════════════
-#  5. SORT ENGINE — 8 algoritmos com telemetria
+#  5. SORT ENGINE — 8 algoritmos instrumentados + backends nativos
 # ══════════════════════════════════════════════════════════════════════════════
-class SortEngine:
-    def _bubble(self,a):
-        a=a[:]; n=len(a); cmps=0
-        for i in range(n):
-            for j in range(n-i-1):
-                cmps+=1
-                if a[j]>a[j+1]: a[j],a[j+1]=a[j+1],a[j]
-        return a,cmps
-    def _insertion(self,a):
-        a=a[:]; cmps=0
-        for i in range(1,len(a)):
-            k=a[i]; j=i-1
-            while j>=0 and a[j]>k: cmps+=1; a[j+1]=a[j]; j-=1
+class SortTelemetry:
+    """Contadores exatos dos kernels didáticos. moves conta escritas de
+    elementos, no array ou em buffer (uma troca = 2); aux é o pico de palavras
+    auxiliares (buffer, contadores ou pilha de índices)."""
+    __slots__=("cmp","swp","mov","aux")
+    def __init__(self): self.cmp=self.swp=self.mov=self.aux=0
+    def as_dict(self, itemsize:int=8) -> Dict:
+        return {"comparisons":self.cmp,"swaps":self.swp,"moves":self.mov,
+                "aux_elements":self.aux,"aux_bytes":self.aux*itemsize}
+
+# Kernels in-place sobre listas. Toda sonda é um statement próprio sobre T.*:
+# _compile_out() remove essas linhas da AST e recompila, gerando a variante
+# sem instrumentação — a mesma fonte, sem custo de contagem.
+def _k_bubble(a,T=None):
+    n=len(a)
+    for i in range(n):
+        for j in range(n-i-1):
+            T.cmp+=1
+            if a[j]>a[j+1]:
+                a[j],a[j+1]=a[j+1],a[j]
+                T.swp+=1; T.mov+=2
+    return a
+
+def _k_insertion(a,T=None):
+    for i in range(1,len(a)):
+        k=a[i]; j=i-1
+        while j>=0:
+            T.cmp+=1
+            if a[j]<=k: break
+            a[j+1]=a[j]; j-=1
+            T.mov+=1
+        if j+1!=i:
             a[j+1]=k
-        return a,cmps
-    def _selection(self,a):
-        a=a[:]; n=len(a); cmps=0
-        for i in range(n):
-            m=i
-            for j in range(i+1,n): cmps+=1; m=j if a[j]<a[m] else m
+            T.mov+=1
+    return a
+
+def _k_selection(a,T=None):
+    n=len(a)
+    for i in range(n):
+        m=i
+        for j in range(i+1,n):
+            T.cmp+=1
+            if a[j]<a[m]: m=j
+        if m!=i:
             a[i],a[m]=a[m],a[i]
-        return a,cmps
-    def _merge_sort(self,a):
-        cmps=[0]
-        def ms(arr):
-            if len(arr)<=1: return arr
-            mid=len(arr)//2
-            L,R=ms(arr[:mid]),ms(arr[mid:])
-            out=[]; i=j=0
-            while i<len(L) and j<len(R):
-                cmps[0]+=1
-                if L[i]<=R[j]: out.append(L[i]); i+=1
-                else: out.append(R[j]); j+=1
-            return out+L[i:]+R[j:]
-        return ms(a[:]),cmps[0]
-    def _quick_sort(self,a):
-        cmps=[0]
-        def qs(arr):
-            if len(arr)<=1: return arr
-            p=arr[len(arr)//2]; L=[]; M=[]; R=[]
-            for x in arr:
-                cmps[0]+=1
-                if x<p: L.append(x)
-                elif x==p: M.append(x)
-                else: R.append(x)
-            return qs(L)+M+qs(R)
-        return qs(a[:]),cmps[0]
-    def _heap_sort(self,a):
-        import heapq; cmps=[0]
-        h=a[:]
-        heapq.heapify(h)
-        return [heapq.heappop(h) for _ in range(len(h))],len(a)
-    def _shell_sort(self,a):
-        a=a[:]; n=len(a); gap=n//2; cmps=0
-        while gap>0:
-            for i in range(gap,n):
-                tmp=a[i]; j=i
-                while j>=gap and a[j-gap]>tmp: cmps+=1; a[j]=a[j-gap]; j-=gap
+            T.swp+=1; T.mov+=2
+    return a
+
+def _k_merge(a,T=None):
+    b=a[:]
+    T.aux=len(a)
+    def ms(lo,hi):
+        if hi-lo<=1: return
+        mid=lo+(hi-lo)//2; ms(lo,mid); ms(mid,hi)
+        b[lo:mid]=a[lo:mid]; i,j,k=lo,mid,lo
+        while i<mid and j<hi:
+            T.cmp+=1
+            if b[i]<=a[j]: a[k]=b[i]; i+=1
+            else: a[k]=a[j]; j+=1
+            k+=1
+        a[k:k+mid-i]=b[i:mid]   # o que sobra da direita já está no lugar
+        T.mov+=(mid-lo)+(k-lo)+(mid-i)
+    ms(0,len(a))
+    return a
+
+def _k_quick(a,T=None):
+    # 3 vias (Dijkstra) com mediana de 3; menor lado primeiro → pilha O(log n)
+    stack=[(0,len(a))]
+    while stack:
+        T.aux=max(T.aux,2*len(stack))
+        lo,hi=stack.pop()
+        if hi-lo<=1: continue
+        x,y,z=a[lo],a[(lo+hi)//2],a[hi-1]
+        T.cmp+=1
+        if x>y: x,y=y,x
+        T.cmp+=1
+        if y>z:
+            y=z
+            T.cmp+=1
+            if x>y: y=x
+        p=y; lt,i,gt=lo,lo,hi
+        while i<gt:
+            T.cmp+=1
+            if a[i]<p:
+                a[lt],a[i]=a[i],a[lt]; lt+=1; i+=1
+                T.swp+=1; T.mov+=2
+            else:
+                T.cmp+=1
+                if a[i]>p:
+                    gt-=1; a[i],a[gt]=a[gt],a[i]
+                    T.swp+=1; T.mov+=2
+                else: i+=1
+        if lt-lo<hi-gt: stack+=[(gt,hi),(lo,lt)]
+        else: stack+=[(lo,lt),(gt,hi)]
+    return a
+
+def _k_heap(a,T=None):
+    n=len(a)
+    def sift(i,end):
+        x=a[i]
+        while True:
+            c=2*i+1
+            if c>=end: break
+            if c+1<end:
+                T.cmp+=1
+                if a[c+1]>a[c]: c+=1
+            T.cmp+=1
+            if a[c]<=x: break
+            a[i]=a[c]; i=c
+            T.mov+=1
+        a[i]=x
+        T.mov+=1
+    for i in range(n//2-1,-1,-1): sift(i,n)
+    for end in range(n-1,0,-1):
+        a[0],a[end]=a[end],a[0]
+        T.swp+=1; T.mov+=2
+        sift(0,end)
+    return a
+
+def _k_shell(a,T=None):
+    n=len(a); gap=n//2
+    while gap>0:
+        for i in range(gap,n):
+            tmp=a[i]; j=i
+            while j>=gap:
+                T.cmp+=1
+                if a[j-gap]<=tmp: break
+                a[j]=a[j-gap]; j-=gap
+                T.mov+=1
+            if j!=i:
                 a[j]=tmp
-            gap//=2
-        return a,cmps
-    def _counting_sort(self,a):
-        if not a: return [],0
-        mn,mx=min(a),max(a)
-        count=[0]*(mx-mn+1)
-        for x in a: count[x-mn]+=1
-        out=[]
-        for i,c in enumerate(count): out.extend([i+mn]*c)
-        return out,len(a)
+                T.mov+=1
+        gap//=2
+    return a
+
+def _k_counting(a,T=None):
+    if not a: return a
+    mn,mx=min(a),max(a)
+    T.cmp+=2*(len(a)-1)
+    count=[0]*(mx-mn+1)
+    T.aux=len(count)
+    for x in a: count[x-mn]+=1
+    i=0
+    for v,c in enumerate(count):
+        if c: a[i:i+c]=[v+mn]*c; i+=c
+    T.mov+=len(a)
+    return a
+
+class _StripProbes(ast.NodeTransformer):
+    """Remove da AST todo statement que escreve em T.* (as sondas)."""
+    @staticmethod
+    def _probe(s):
+        t=getattr(s,"target",None)
+        if isinstance(s,ast.Assign) and len(s.targets)==1: t=s.targets[0]
+        return isinstance(t,ast.Attribute) and isinstance(t.value,ast.Name) and t.value.id=="T"
+    def generic_visit(self, node):
+        super().generic_visit(node)
+        for f in ("body","orelse"):
+            b=getattr(node,f,None)
+            if isinstance(b,list) and b and isinstance(b[0],ast.stmt):
+                nb=[s for s in b if not self._probe(s)]
+                setattr(node,f,nb or ([ast.Pass()] if f=="body" else []))
+        return node
+
+def _compile_out(fn):
+    """Variante zero-overhead de um kernel: mesma fonte, sem as sondas."""
+    try:
+        tree=ast.fix_missing_locations(_StripProbes().visit(ast.parse(textwrap.dedent(inspect.getsource(fn)))))
+        ns={}; exec(compile(tree,f"<fast {fn.__name__}>","exec"),fn.__globals__,ns)
+        return ns[fn.__name__]
+    except (OSError,TypeError):   # fonte indisponível (ex.: bytecode apenas)
+        return lambda a,T=None:fn(a,SortTelemetry())
+
+SORT_KERNELS={"bubble":_k_bubble,"insertion":_k_insertion,"selection":_k_selection,
+              "merge":_k_merge,"quick":_k_quick,"heap":_k_heap,"shell":_k_shell,
+              "counting":_k_counting}
+SORT_KERNELS_FAST={k:_compile_out(f) for k,f in SORT_KERNELS.items()}
+
+
+class SortEngine:
+    PAR_MIN=1<<16       # abaixo disso o paralelismo não compensa o overhead
+    OVERSAMPLE=32       # amostras por bloco na escolha dos splitters
+
+    def __init__(self, pool:'WorkerPool'=None):
+        self.pool=pool or WorkerPool()
+
+    TEACHING_ALGOS=list(SORT_KERNELS)
+
+    def _check_counting(self, a:List) -> List:
+        if a and max(a)-min(a)+1>max(self.COUNTING_MAX,4*len(a)):
+            raise ValueError(f"Faixa {max(a)-min(a)+1} grande demais para counting sort; use algorithm=auto")
+        return a
+
+    def _teach(self, name:str, a:List, instrument:bool=True):
+        """Roda um kernel didático numa cópia; (ordenado, telemetria|None)."""
+        if name=="counting": self._check_counting(a)
+        if not instrument: return SORT_KERNELS_FAST[name](a[:]),None
+        T=SortTelemetry(); return SORT_KERNELS[name](a[:],T),T
+
+    # (ordenado, comparações) — interface usada pela seleção e pelo dispatcher
+    def _bubble(self,a):        r,T=self._teach("bubble",a);    return r,T.cmp
+    def _insertion(self,a):     r,T=self._teach("insertion",a); return r,T.cmp
+    def _selection(self,a):     r,T=self._teach("selection",a); return r,T.cmp
+    def _merge_sort(self,a):    r,T=self._teach("merge",a);     return r,T.cmp
+    def _quick_sort(self,a):    r,T=self._teach("quick",a);     return r,T.cmp
+    def _heap_sort(self,a):     r,T=self._teach("heap",a);      return r,T.cmp
+    def _shell_sort(self,a):    r,T=self._teach("shell",a);     return r,T.cmp
+    def _counting_sort(self,a): r,T=self._teach("counting",a);  return r,T.cmp
+
+    def _sample_sort(self,a:np.ndarray,workers:int=0,perm:bool=False)->Tuple[np.ndarray,Optional[np.ndarray],Dict]:
+        """Sample sort paralelo (PSRS): ordena blocos, escolhe p-1 splitters por
+        amostragem regular, particiona cada bloco por busca binária e intercala
+        cada bucket de forma independente no pool. Com perm=True carrega os
+        índices junto (argsort estável: blocos e buckets preservam a ordem)."""
+        p=max(1,min(workers or self.pool.threads,len(a)//self.PAR_MIN or 1))
+        ph={"local_sort_us":0.0,"sample_us":0.0,"partition_us":0.0,"merge_us":0.0}
+        t=time.perf_counter()
+        if p==1:
+            idx=np.argsort(a,kind="stable") if perm else None
+            out=a[idx] if perm else np.sort(a)
+            ph["local_sort_us"]=round((time.perf_counter()-t)*1e6,4)
+            return out,idx,{"workers":1,"phases_us":ph}
+        cuts=np.linspace(0,len(a),p+1).astype(np.int64)
+        def local(i):
+            c=a[cuts[i]:cuts[i+1]]
+            if not perm: return np.sort(c),None
+            o=np.argsort(c,kind="stable"); return c[o],o+cuts[i]
+        runs,ids=zip(*self.pool.map(local,range(p),workers=p))
+        ph["local_sort_us"]=round((time.perf_counter()-t)*1e6,4); t=time.perf_counter()
+        s=min(self.OVERSAMPLE,min(len(r) for r in runs))
+        smp=np.sort(np.concatenate([r[np.linspace(0,len(r)-1,s).astype(np.int64)] for r in runs]))
+        spl=smp[np.arange(1,p)*len(smp)//p]
+        ph["sample_us"]=round((time.perf_counter()-t)*1e6,4); t=time.perf_counter()
+        bnd=self.pool.map(lambda r:np.concatenate(([0],np.searchsorted(r,spl,side="right"),[len(r)])),runs,workers=p)
+        sizes=np.sum([b[1:]-b[:-1] for b in bnd],axis=0)
+        offs=np.concatenate(([0],np.cumsum(sizes)))
+        ph["partition_us"]=round((time.perf_counter()-t)*1e6,4); t=time.perf_counter()
+        out=np.empty_like(a); pout=np.empty(len(a),dtype=np.int64) if perm else None
+        def merge(j):
+            # os pedaços já estão ordenados: o timsort (kind=stable) só intercala as runs
+            keys=np.concatenate([r[b[j]:b[j+1]] for r,b in zip(runs,bnd)])
+            if not perm: out[offs[j]:offs[j+1]]=np.sort(keys,kind="stable"); return
+            o=np.argsort(keys,kind="stable")
+            out[offs[j]:offs[j+1]]=keys[o]
+            pout[offs[j]:offs[j+1]]=np.concatenate([x[b[j]:b[j+1]] for x,b in zip(ids,bnd)])[o]
+        self.pool.map(merge,range(p),workers=p)
+        ph["merge_us"]=round((time.perf_counter()-t)*1e6,4)
+        return out,pout,{"workers":p,"phases_us":ph,"bucket_sizes":[int(x) for x in sizes]}
+
+    def parallel(self, data:Optional[List[float]]=None, size:int=0, workers:int=0) -> Dict:
+        """Sample sort paralelo sobre `data` ou sobre `size` valores aleatórios
+        gerados no servidor, com tempos por fase e speedup contra np.sort serial."""
+        a=self._coerce(data,"auto") if data else np.random.randint(-2**62,2**62,size,dtype=np.int64)
+        if not len(a): return {"error":"Informe data ou size"}
+        t0=time.perf_counter(); out,_,info=self._sample_sort(a,workers)
+        lat=(time.perf_counter()-t0)*1e6
+        t0=time.perf_counter(); np.sort(a); serial=(time.perf_counter()-t0)*1e6
+        return {"algorithm":"sample","input_size":len(a),"dtype":str(a.dtype),**info,
+                "sorted":self._jsonable(out[:50]),"latency_us":round(lat,4),
+                "serial_us":round(serial,4),"speedup":round(serial/lat,3) if lat else None,
+                "throughput_meps":round(len(a)/lat,3) if lat else None,
+                "is_sorted":self._is_sorted(out)}
+
+    # ── Despacho adaptativo (algorithm="auto") ──────────────────────────────
+    AUTO_TINY=32            # até aqui insertion sort vence qualquer kernel
+    AUTO_RUN_RATIO=32       # runs*32 <= n → "quase ordenado" → timsort
+    RADIX_RANGE=1<<16       # faixa que cabe em uint16: radix sort estável do NumPy
+    COUNTING_MAX=1<<24      # teto de contadores do counting sort (além de 4n)
+    LOWCARD_RATIO=1/64      # distintos/amostra abaixo disso → argsort por ids de chave
+
+    def _features(self,a:np.ndarray)->Tuple[Dict,Optional[np.ndarray]]:
+        """Presortedness (runs), faixa e cardinalidade. Runs são contadas no
+        array inteiro (um passe vetorizado); cardinalidade numa amostra."""
+        n=len(a); f={"n":n,"dtype":str(a.dtype),"runs":1,"descending_runs":1,"range":None,"distinct_ratio":1.0}
+        if n<2: return f,None
+        f["runs"]=int(np.count_nonzero(a[1:]<a[:-1]))+1
+        f["descending_runs"]=int(np.count_nonzero(a[1:]>a[:-1]))+1
+        if a.dtype.kind=="i": f["range"]=int(a.max())-int(a.min())+1
+        smp=a if n<=4096 else a[np.random.randint(0,n,4096)]
+        u=np.unique(smp); f["distinct_ratio"]=round(len(u)/len(smp),4)
+        return f,u
+
+    def _distinct(self,a:np.ndarray,keys:np.ndarray):
+        """Poucas chaves distintas (<= 64 na amostra), com permutação: o id de
+        cada valor sai de d passes de comparação (ids += a >= chave) e a
+        permutação estável do radix sort do NumPy sobre ids uint8 — bem mais
+        barato que o argsort estável (timsort) sobre os valores. None se
+        algum valor não estiver entre as chaves da amostra."""
+        ids=np.zeros(len(a),dtype=np.uint8)
+        for k in keys[1:]: ids+=a>=k
+        if np.any(keys[ids]!=a): return None
+        idx=np.argsort(ids,kind="stable"); return a[idx],idx
+
+    def _radix(self,a:np.ndarray,perm:bool):
+        """Faixa densa: desloca para uint16 e usa o radix sort do NumPy (kind=stable)."""
+        mn=a.min(); k=(a-mn).astype(np.uint16)
+        if perm: idx=np.argsort(k,kind="stable"); return a[idx],idx
+        return np.sort(k,kind="stable").astype(a.dtype)+mn,None
+
+    def _auto(self,a:np.ndarray,perm:bool=False,stable:bool=False,workers:int=0):
+        """Inspeciona os dados e despacha para o melhor kernel. Retorna
+        (ordenado, permutação|None, comparações|None, decisão)."""
+        f,keys=self._features(a); n=f["n"]; cmps=None; idx=None
+        nan=a.dtype.kind=="f" and bool(np.isnan(a).any())
+        low=perm and keys is not None and not nan and len(keys)<=64 and f["distinct_ratio"]<=self.LOWCARD_RATIO
+        if n<=self.AUTO_TINY and not perm and not nan:
+            algo,why="insertion",f"n={n} <= {self.AUTO_TINY}"
+            vals,cmps=self._insertion(a.tolist()); out=np.asarray(vals,dtype=a.dtype)
+        elif f["runs"]*self.AUTO_RUN_RATIO<=n or f["descending_runs"]*self.AUTO_RUN_RATIO<=n:
+            algo="timsort"; why=f"{f['runs']} runs ascendentes / {f['descending_runs']} descendentes em n={n}"
+            if f["descending_runs"]<f["runs"] and not perm and not nan: a=a[::-1]   # vira runs ascendentes
+            if perm: idx=np.argsort(a,kind="stable"); out=a[idx]
+            else: out=np.sort(a,kind="stable")
+        elif f["range"] is not None and f["range"]<=self.RADIX_RANGE:
+            algo,why="radix",f"faixa inteira {f['range']} <= {self.RADIX_RANGE}"
+            out,idx=self._radix(a,perm)
+        elif low and (r:=self._distinct(a,keys)) is not None:
+            algo,why="distinct",f"{len(keys)} chaves distintas (razão {f['distinct_ratio']} <= {self.LOWCARD_RATIO:.4f})"
+            out,idx=r
+        elif n>=self.PAR_MIN and min(workers or self.pool.threads,n//self.PAR_MIN)>1:
+            algo,why="sample",f"n={n} >= {self.PAR_MIN} com {min(workers or self.pool.threads,n//self.PAR_MIN)} workers"
+            out,idx,_=self._sample_sort(a,workers,perm)
+        else:
+            kind="stable" if stable else "quicksort"
+            algo="timsort" if stable else "introsort"
+            why="estabilidade exigida" if stable else "dados gerais, sem estrutura explorável"
+            if perm: idx=np.argsort(a,kind=kind); out=a[idx]
+            else: out=np.sort(a,kind=kind)
+        return out,idx,cmps,{"algorithm":algo,"reason":why,"features":f}
+
+    ALL_ALGOS=["bubble","insertion","selection","merge","quick","heap","shell","counting","native","sample","auto"]
+    NATIVE_ALGOS=["native","sample","auto"]
+    DTYPES={"int64":np.int64,"float64":np.float64,"float32":np.float32}
+    MODES=["sort","argsort","kv"]
+
+    def _coerce(self,data,dtype:str)->np.ndarray:
+        """Converte preservando o tipo. 'auto' mantém int64 quando todos os
+        valores são inteiros representáveis; senão float64. Inteiros do JSON
+        entram exatos (sem passar por float); com int64, valores fracionários
+        são recusados em vez de truncados."""
+        ints=not isinstance(data,np.ndarray) and all(type(x) is int for x in data)
+        if ints:
+            try: a=np.array(data,dtype=np.int64)
+            except OverflowError:
+                if dtype=="int64": raise ValueError("Valor fora da faixa de int64")
+                a=None
+            if a is not None: return a if dtype in ("auto","int64") else a.astype(self.DTYPES[dtype])
+        if dtype=="auto":
+            a=np.asarray(data,dtype=np.float64)
+            if len(a) and np.isfinite(a).all() and np.all(a==np.trunc(a)) and np.abs(a).max()<2**63:
+                return a.astype(np.int64)
+            return a
+        if dtype not in self.DTYPES: raise ValueError(f"dtype inválido. Use: {['auto',*self.DTYPES]}")
+        if dtype=="int64":
+            a=np.asarray(data,dtype=np.float64)
+            if np.isnan(a).any(): raise ValueError("NaN exige dtype float64 ou float32")
+            if not (np.isfinite(a).all() and np.all(a==np.trunc(a))): raise ValueError("dtype int64 exige valores inteiros")
+            if isinstance(data,np.ndarray): return data.astype(np.int64)
+            try: return np.array([x if type(x) is int else int(x) for x in data],dtype=np.int64)   # ints exatos + floats inteiros
+            except OverflowError: raise ValueError("Valor fora da faixa de int64")
+        return np.asarray(data,dtype=self.DTYPES[dtype])
+
+    @staticmethod
+    def _nan_first(out:np.ndarray,idx:Optional[np.ndarray]):
+        """NumPy ordena NaN por último; gira o bloco de NaN para o início."""
+        k=int(np.isnan(out).sum()) if out.dtype.kind=="f" else 0
+        if not k: return out,idx
+        return np.roll(out,k),(np.roll(idx,k) if idx is not None else None)
 
-    ALL_ALGOS=["bubble","insertion","selection","merge","quick","heap","shell","counting"]
+    @staticmethod
+    def _is_sorted(out:np.ndarray)->bool:
+        v=out[~np.isnan(out)] if out.dtype.kind=="f" else out
+        return bool(np.all(v[:-1]<=v[1:]))
 
-    def sort(self, data:List[float], algorithm:str) -> Dict:
+    @staticmethod
+    def _jsonable(a:np.ndarray)->List:
+        """NaN não é JSON válido: sai como null."""
+        if a.dtype.kind!="f": return a.tolist()
+        return [None if x!=x else x for x in a.tolist()]
+
+    def sort(self, data:List[float], algorithm:str, workers:int=0, dtype:str="auto",
+             mode:str="sort", stable:bool=False, nan_position:str="last",
+             payload:Optional[Dict[str,List[Any]]]=None, limit:int=50, instrument:bool=True) -> Dict:
         t0=time.perf_counter()
-        fn={"bubble":self._bubble,"insertion":self._insertion,
-            "selection":self._selection,"merge":self._merge_sort,
-            "quick":self._quick_sort,"heap":self._heap_sort,
-            "shell":self._shell_sort,"counting":self._counting_sort}.get(algorithm)
-        if not fn: return {"error":f"Algoritmo inválido. Use: {self.ALL_ALGOS}"}
+        teach=algorithm in self.TEACHING_ALGOS
+        if not teach and algorithm not in self.NATIVE_ALGOS:
+            return {"error":f"Algoritmo inválido. Use: {self.ALL_ALGOS}"}
+        if mode not in self.MODES: return {"error":f"Modo inválido. Use: {self.MODES}"}
+        if mode!="sort" and teach: return {"error":f"argsort/kv exigem backend nativo: {self.NATIVE_ALGOS}"}
+        if mode=="kv" and not payload: return {"error":"kv exige payload"}
+        if payload and any(len(c)!=len(data) for c in payload.values()):
+            return {"error":"Colunas do payload devem ter o mesmo tamanho de data"}
         try:
-            inp=[int(x) for x in data]
-            sorted_data,comparisons=fn(inp)
+            a=self._coerce(data,dtype); info={}; idx=None; comparisons=None
+            if teach:
+                if algorithm=="counting" and a.dtype.kind=="f":
+                    return {"error":"counting exige valores inteiros (dtype int64)"}
+                nan=np.isnan(a) if a.dtype.kind=="f" else np.zeros(len(a),dtype=bool)
+                vals,T=self._teach(algorithm,a[~nan].tolist(),instrument)
+                out=np.concatenate((np.asarray(vals,dtype=a.dtype),a[nan]))
+                if T: info=T.as_dict(a.itemsize); comparisons=info.pop("comparisons")
+            elif algorithm=="sample":
+                out,idx,info=self._sample_sort(a,workers,perm=mode!="sort")
+            elif algorithm=="auto":
+                out,idx,comparisons,dec=self._auto(a,mode!="sort",stable,workers)
+                info={"decision":dec}
+            else:
+                kind="stable" if stable else "quicksort"
+                if mode=="sort": out=np.sort(a,kind=kind)
+                else: idx=np.argsort(a,kind=kind); out=a[idx]
+            if nan_position=="first": out,idx=self._nan_first(out,idx)
         except Exception as e: return {"error":str(e)}
         lat=(time.perf_counter()-t0)*1e6
-        return {"algorithm":algorithm,"input_size":len(data),
-                "sorted":sorted_data[:50],"comparisons":comparisons,
-                "latency_us":round(lat,4),
-                "is_sorted":sorted_data==sorted(sorted_data)}
+        r={"algorithm":algorithm,"input_size":len(data),"dtype":str(a.dtype),"mode":mode,
+           "stable":bool(stable or algorithm in ("bubble","insertion","merge","counting","sample")
+                         or (algorithm=="auto" and info["decision"]["algorithm"]!="introsort")),
+           "nan_position":nan_position,"comparisons":comparisons,"latency_us":round(lat,4),**info,
+           "is_sorted":self._is_sorted(out)}
+        if mode!="argsort": r["sorted"]=self._jsonable(out[:limit])
+        if mode!="sort": r["permutation"]=idx[:limit].tolist()
+        if mode=="kv":
+            # uma única gather por coluna, e só das linhas devolvidas
+            top=idx[:limit]
+            r["payload"]={k:[c[i] for i in top] for k,c in payload.items()}
+        return r
+
+    def _runner(self, algorithm:str):
+        """(kernel, preparo, sonda) para medição. O kernel didático é a variante
+        sem instrumentação e ordena a lista no lugar (quem mede passa uma cópia
+        feita fora do tempo); o preparo (lista Python) também fica fora do tempo
+        medido e a sonda roda uma vez, à parte, a versão instrumentada."""
+        if algorithm in self.TEACHING_ALGOS:
+            fast=SORT_KERNELS_FAST[algorithm]
+            def prep(a): x=a.tolist(); return self._check_counting(x) if algorithm=="counting" else x
+            def probe(x): return self._teach(algorithm,x)[1].as_dict()
+            return fast,prep,probe
+        if algorithm=="native": return np.sort,(lambda a:a),None
+        if algorithm=="sample": return (lambda a:self._sample_sort(a)[0]),(lambda a:a),None
+        if algorithm=="auto":   return (lambda a:self._auto(a)[0]),(lambda a:a),None
+        raise ValueError(f"Algoritmo inválido. Use: {self.ALL_ALGOS}")
 
     def benchmark(self, data:List[float]) -> Dict:
         """Compara todos os algoritmos no mesmo dataset."""
@@ -390,69 +753,1460 @@ class SortEngine:
         fastest=min(results,key=lambda k:results[k]["latency_us"])
         return {"input_size":len(data),"results":results,"fastest":fastest}
 
+    # ── Seleção parcial: top-k, nth_element, partial_sort, multiselect ──────
+    SELECT_OPS=["topk","nth_element","partial_sort","multiselect"]
+    SELECT_PY_MAX=20_000   # até aqui o backend auto usa os kernels instrumentados
+
+    def _heap_topk(self,a,k:int,largest:bool=True):
+        """Top-k com min-heap de tamanho k: O(n log k) comparações."""
+        s=1 if largest else -1; h=[]; cmps=0
+        def down(i):
+            nonlocal cmps; n=len(h)
+            while True:
+                l=2*i+1; m=i
+                if l<n:   cmps+=1; m=l if h[l]<h[m] else m
+                if l+1<n: cmps+=1; m=l+1 if h[l+1]<h[m] else m
+                if m==i: return
+                h[i],h[m]=h[m],h[i]; i=m
+        for x in a:
+            v=s*x
+            if len(h)<k:
+                h.append(v); i=len(h)-1
+                while i:
+                    p=(i-1)//2; cmps+=1
+                    if h[i]<h[p]: h[i],h[p]=h[p],h[i]; i=p
+                    else: break
+            else:
+                cmps+=1
+                if v>h[0]: h[0]=v; down(0)
+        out=[]
+        while h: h[0],h[-1]=h[-1],h[0]; out.append(h.pop()); down(0)
+        return [s*v for v in reversed(out)],cmps
+
+    def _introselect(self,a,ranks:List[int]):
+        """Quickselect multi-rank com partição em 3 vias e mediana de 3; ao
+        estourar a profundidade 2·log2(n) o trecho cai para merge sort, o que
+        limita o pior caso a O(n log n). Retorna (valores, lista particionada, cmps)."""
+        a=a[:]; cmps=0
+        stack=[(0,len(a),sorted(set(ranks)),2*max(1,len(a)).bit_length())]
+        while stack:
+            lo,hi,rk,d=stack.pop()
+            if not rk or hi-lo<=1: continue
+            if d==0 or hi-lo<=16:
+                seg,c=self._merge_sort(a[lo:hi]); a[lo:hi]=seg; cmps+=c; continue
+            p=sorted((a[lo],a[(lo+hi)//2],a[hi-1]))[1]; cmps+=3
+            lt,i,gt=lo,lo,hi
+            while i<gt:
+                cmps+=1
+                if a[i]<p: a[lt],a[i]=a[i],a[lt]; lt+=1; i+=1
+                else:
+                    cmps+=1
+                    if a[i]>p: gt-=1; a[i],a[gt]=a[gt],a[i]
+                    else: i+=1
+            stack.append((lo,lt,[r for r in rk if r<lt],d-1))
+            stack.append((gt,hi,[r for r in rk if r>=gt],d-1))
+        return [a[r] for r in ranks],a,cmps
+
+    def _par_topk(self,a:np.ndarray,k:int,largest:bool,workers:int=0)->np.ndarray:
+        """Top-k por blocos: cada worker reduz seu bloco a k candidatos. NaN
+        fica de fora, como no caminho Python e no TopKStream."""
+        p=max(1,min(workers or self.pool.threads,len(a)//self.PAR_MIN or 1))
+        src=a if largest else -a
+        def cand(c): return c if len(c)<=k else np.partition(c,len(c)-k)[len(c)-k:]
+        def block(c): return cand(c[~np.isnan(c)] if c.dtype.kind=="f" else c)
+        cuts=np.linspace(0,len(a),p+1).astype(np.int64)
+        c=np.concatenate(self.pool.map(lambda i:block(src[cuts[i]:cuts[i+1]]),range(p),workers=p))
+        top=-np.sort(-cand(c))
+        return top if largest else -top
+
+    def _par_select(self,a:np.ndarray,ranks:List[int],workers:int=0)->List:
+        """Multiselect paralelo por filtragem amostral: intervalos [lo,hi] da
+        amostra cercam cada rank, um único passe paralelo conta quantos valores
+        caem abaixo de cada intervalo e recolhe os que caem dentro; só esses
+        candidatos (poucos) são particionados. Rank fora do intervalo → np.partition."""
+        n=len(a); p=max(1,min(workers or self.pool.threads,n//self.PAR_MIN or 1))
+        if p==1 or (a.dtype.kind=="f" and np.isnan(a).any()):
+            return np.partition(a,ranks)[ranks].tolist()
+        S=min(n,1<<14); d=int(2*math.sqrt(S))+1
+        smp=np.sort(a[np.random.randint(0,n,S)])
+        iv=sorted((smp[max(0,r*S//n-d)],smp[min(S-1,r*S//n+d)]) for r in ranks)
+        m=[list(iv[0])]
+        for lo,hi in iv[1:]:
+            if lo<=m[-1][1]: m[-1][1]=max(m[-1][1],hi)
+            else: m.append([lo,hi])
+        los=np.array([x[0] for x in m]); his=np.array([x[1] for x in m])
+        cuts=np.linspace(0,n,p+1).astype(np.int64)
+        def scan(i):
+            c=a[cuts[i]:cuts[i+1]]
+            j=np.searchsorted(his,c,side="left"); ids=2*j+(np.searchsorted(los,c,side="right")-j)
+            return np.bincount(ids,minlength=2*len(m)+1),c[ids%2==1],ids[ids%2==1]
+        parts=self.pool.map(scan,range(p),workers=p)
+        cnt=np.sum([x[0] for x in parts],axis=0)
+        vals=np.concatenate([x[1] for x in parts]); ids=np.concatenate([x[2] for x in parts])
+        out=[]; full=None
+        for r in ranks:
+            k=int(np.searchsorted(his,smp[min(S-1,r*S//n)],side="left"))
+            below=int(cnt[:2*k+1].sum()) if k<len(m) else n
+            cand=np.sort(vals[ids==2*k+1]) if k<len(m) else vals[:0]
+            if below<=r<below+len(cand): out.append(cand[r-below].item()); continue
+            if full is None: full=np.partition(a,ranks)
+            out.append(full[r].item())
+        return out
+
+    def select(self, op:str, data:List[float], k:int=10, ranks:Optional[List[int]]=None,
+               quantiles:Optional[List[float]]=None, largest:bool=True, dtype:str="auto",
+               backend:str="auto", workers:int=0) -> Dict:
+        """Seleção sem ordenar tudo: O(n) (introselect) ou O(n log k) (heap)."""
+        t0=time.perf_counter()
+        if op not in self.SELECT_OPS: return {"error":f"Operação inválida. Use: {self.SELECT_OPS}"}
+        try: a=self._coerce(data,dtype)
+        except Exception as e: return {"error":str(e)}
+        n=len(a)
+        if op in ("nth_element","multiselect"):
+            if quantiles: ranks=[int(round(q*(n-1))) for q in quantiles]
+            if op=="nth_element": ranks=[k]
+            if not ranks: return {"error":"multiselect exige ranks ou quantiles"}
+            if any(r<0 or r>=n for r in ranks): return {"error":f"Ranks devem estar em [0,{n-1}]"}
+        elif not 1<=k<=n: return {"error":f"k deve estar em [1,{n}]"}
+        py=backend=="python" or (backend=="auto" and n<=self.SELECT_PY_MAX)
+        cmps=None
+        if py and a.dtype.kind=="f" and np.isnan(a).any(): py=False   # NaN quebra comparações em Python
+        if py:
+            lst=a.tolist()
+            if op=="topk": vals,cmps=self._heap_topk(lst,k,largest)
+            elif op=="partial_sort":
+                r=n-k if largest else k-1
+                _,part,cmps=self._introselect(lst,[r])
+                vals,c=self._merge_sort(part[r:] if largest else part[:k]); cmps+=c
+                if largest: vals=vals[::-1]
+            else: vals,_,cmps=self._introselect(lst,ranks)
+        elif op in ("topk","partial_sort"):
+            vals=self._jsonable(self._par_topk(a,k,largest,workers))
+        else:
+            vals=self._par_select(a,ranks,workers)
+        lat=(time.perf_counter()-t0)*1e6
+        r={"operation":op,"input_size":n,"dtype":str(a.dtype),"backend":"python" if py else "native",
+           "values":vals,"comparisons":cmps,"latency_us":round(lat,4)}
+        if op in ("topk","partial_sort"): r.update(k=k,largest=largest)
+        else: r["ranks"]=ranks
+        return r
+
+    # ── Sort segmentado: muitos arrays pequenos numa chamada ────────────────
+    SEG_NET_MAX=16          # até aqui: rede de ordenação vetorizada entre segmentos
+    SEG_PAD_MAX=4096        # até aqui: matriz com padding + np.sort por linha
+    SEG_ROWS=1<<14          # linhas por tarefa no pool
+
+    @staticmethod
+    def _batcher(n:int) -> List[Tuple[int,int]]:
+        """Comparadores da rede odd-even merge sort de Batcher (n potência de 2)."""
+        pairs=[]; p=1
+        while p<n:
+            k=p
+            while k>=1:
+                for j in range(k%p,n-k,2*k):
+                    for i in range(min(k,n-j-k)):
+                        if (i+j)//(2*p)==(i+j+k)//(2*p): pairs.append((i+j,i+j+k))
+                k//=2
+            p*=2
+        return pairs
+
+    def segmented(self, values:Any, offsets:List[int], dtype:str="auto", workers:int=0) -> Dict:
+        """Ordena cada segmento values[offsets[i]:offsets[i+1]] de forma
+        independente e devolve no mesmo layout empacotado. Estratégia por
+        tamanho: rede de Batcher aplicada coluna a coluna sobre todos os
+        segmentos da mesma largura (≤16), matriz com padding e np.sort por
+        linha (≤4096) e np.sort individual para os grandes — tudo no pool."""
+        t0=time.perf_counter()
+        try: a=values if isinstance(values,np.ndarray) else self._coerce(values,dtype)
+        except Exception as e: return {"error":str(e)}
+        off=np.asarray(offsets,dtype=np.int64)
+        if len(off)<1 or off[0]!=0 or off[-1]!=len(a) or np.any(off[1:]<off[:-1]):
+            return {"error":"offsets deve começar em 0, ser não-decrescente e terminar em len(values)"}
+        out=a.copy(); st=off[:-1]; ln=off[1:]-off[:-1]
+        fl=a.dtype.kind=="f"; big=np.iinfo(a.dtype).max if not fl else None
+        if fl: cs=np.concatenate(([0],np.cumsum(np.isnan(a)))); segnan=(cs[off[1:]]-cs[off[:-1]])>0
+        tasks=[]; buckets={"network":0,"padded":0,"large":0}
+        def pad_sort(s,l,W,net):
+            idx=s[:,None]+np.arange(W); ok=np.arange(W)<l[:,None]
+            # ints: máximo do tipo; floats: +inf na rede, NaN no np.sort (vai para o
+            # fim junto com os NaN reais, então os l primeiros continuam corretos)
+            M=np.full((len(s),W),big if not fl else (np.inf if net else np.nan),dtype=a.dtype)
+            M[ok]=a[idx[ok]]
+            if net:
+                M=np.ascontiguousarray(M.T)      # uma linha por posição: colunas contíguas
+                for i,j in self._batcher(W):
+                    lo=np.minimum(M[i],M[j]); np.maximum(M[i],M[j],out=M[j]); M[i]=lo
+                M=M.T
+            else: M.sort(axis=1)
+            out[idx[ok]]=M[ok]
+        W=2
+        while W<=self.SEG_PAD_MAX:
+            sel=np.nonzero((ln>W//2)&(ln<=W))[0] if W>2 else np.nonzero(ln==2)[0]
+            if len(sel):
+                net=W<=self.SEG_NET_MAX
+                if net and fl:   # NaN quebra min/max: esses segmentos vão para o caminho com padding
+                    slow=sel[segnan[sel]]; sel=sel[~segnan[sel]]
+                    for r in range(0,len(slow),self.SEG_ROWS):
+                        tasks.append((pad_sort,st[slow[r:r+self.SEG_ROWS]],ln[slow[r:r+self.SEG_ROWS]],W,False))
+                    buckets["padded"]+=len(slow)
+                for r in range(0,len(sel),self.SEG_ROWS):
+                    tasks.append((pad_sort,st[sel[r:r+self.SEG_ROWS]],ln[sel[r:r+self.SEG_ROWS]],W,net))
+                buckets["network" if net else "padded"]+=len(sel)
+            W*=2
+        large=np.nonzero(ln>self.SEG_PAD_MAX)[0]; buckets["large"]=len(large)
+        def sort_one(i): out[off[i]:off[i+1]]=np.sort(a[off[i]:off[i+1]])
+        tasks+=[(sort_one,i) for i in large]
+        self.pool.map(lambda t:t[0](*t[1:]),tasks,workers=workers)
+        lat=(time.perf_counter()-t0)*1e6; nseg=len(ln)
+        return {"segments":nseg,"input_size":len(a),"dtype":str(a.dtype),"buckets":buckets,
+                "tasks":len(tasks),"values":out,"latency_us":round(lat,4),
+                "segments_per_sec":round(nseg/lat*1e6,2) if lat else None,
+                "throughput_meps":round(len(a)/lat,3) if lat else None}
+
+
+class TopKStream:
+    """Top-k sobre um stream em memória O(k + bloco): os blocos se acumulam até
+    max(4k, 64Ki) valores e então são reduzidos a k candidatos por np.partition."""
+    def __init__(self, k:int, largest:bool=True):
+        self.k=k; self.largest=largest; self.seen=0
+        self._best=None; self._pend=[]; self._np=0
+
+    def _compact(self):
+        if self._best is not None: self._pend.append(self._best)
+        if not self._pend: self._best=np.empty(0); return
+        c=np.concatenate(self._pend); self._pend=[]; self._np=0
+        if self.largest: c=c if len(c)<=self.k else np.partition(c,len(c)-self.k)[len(c)-self.k:]
+        else: c=c if len(c)<=self.k else np.partition(c,self.k-1)[:self.k]
+        self._best=c
+
+    def push(self, chunk:np.ndarray):
+        if not len(chunk): return
+        if chunk.dtype.kind=="f": chunk=chunk[~np.isnan(chunk)]
+        self.seen+=len(chunk); self._pend.append(chunk); self._np+=len(chunk)
+        if self._np>=max(4*self.k,1<<16): self._compact()
+
+    def result(self)->np.ndarray:
+        self._compact()
+        out=np.sort(self._best)
+        return out[::-1] if self.largest else out
+
+
+class LoserTree:
+    """Árvore de perdedores sobre K chaves: winner() em O(1), replace() em
+    O(log K) com uma comparação por nível (metade de um heap binário)."""
+    def __init__(self, keys:List):
+        self.k=len(keys); self.keys=list(keys); self.t=[-1]*max(self.k,1)
+        for i in range(self.k-1,-1,-1): self._replay(i)
+
+    def _replay(self, i:int):
+        w=i; p=(i+self.k)//2
+        while p>0:
+            l=self.t[p]
+            if l==-1: self.t[p]=w; return      # construção: primeiro a chegar espera
+            if self.keys[l]<self.keys[w]: self.t[p],w=w,l
+            p//=2
+        self.t[0]=w
+
+    def winner(self) -> int: return self.t[0]
+
+    def replace(self, i:int, key):
+        """Troca a chave do vencedor atual (i == winner()) e refaz o torneio."""
+        self.keys[i]=key; self._replay(i)
+
+
+class RunMerger:
+    """Intercalação em K vias de runs já ordenadas, bloco a bloco. Cada fonte é
+    um iterador de blocos crescentes; o próximo bloco de cada run é lido em
+    background. Uma árvore de perdedores sobre o último valor do bloco corrente
+    de cada run dá o limite até onde todas podem ser emitidas com segurança; o
+    trecho é intercalado em fatias paralelas (splitters por amostragem, como no
+    sample sort) quando passa de PAR_MIN. Memória de trabalho: ~2K+2 blocos.
+    NaN não entra no merge; sai no final. dedup=True remove repetidos, também
+    entre runs e entre blocos."""
+    def __init__(self, sources:List, dtype:str="float64", dedup:bool=False, workers:int=0,
+                 sorter:Optional[SortEngine]=None, prefetch_threads:int=4, check:bool=True,
+                 metrics:Optional[Dict]=None):
+        self.src=[iter(s) for s in sources]; self.dtype=np.dtype(dtype)
+        self.dedup=dedup; self.workers=workers; self.check=check
+        self.so=sorter or SortEngine(); self.prefetch_threads=prefetch_threads
+        self.metrics=metrics if metrics is not None else {}
+        for k in ("blocks_out","merge_cpu_us","read_io_us","prefetch_wait_us","bytes_read"): self.metrics.setdefault(k,0)
+        self.metrics.update(fan_in=len(self.src),output_size=0,duplicates_dropped=0,nan=0,parallel_slices=0)
+
+    @staticmethod
+    def file_source(path:str, fmt:str="binary", dtype:str="float64", block_elems:int=1<<16):
+        """Blocos de um arquivo de valores (binário little-endian ou texto)."""
+        dec=ArrayDecoder(fmt,dtype); step=block_elems*(dec.dtype.itemsize if fmt=="binary" else 8)
+        with open(path,"rb") as f:
+            while b:=f.read(step):
+                a=dec.feed(b)
+                if len(a): yield a
+        a=dec.close()
+        if len(a): yield a
+
+    @staticmethod
+    def is_sorted(blocks) -> bool:
+        """Confere a ordem de uma run bloco a bloco (NaN é ignorado, como no merge)."""
+        last=None
+        for a in blocks:
+            a=np.asarray(a)
+            if a.dtype.kind=="f": a=a[~np.isnan(a)]
+            if not len(a): continue
+            if (last is not None and a[0]<last) or bool(np.any(a[1:]<a[:-1])): return False
+            last=a[-1]
+        return True
+
+    def _merge_parts(self, parts:List[np.ndarray]) -> np.ndarray:
+        n=sum(len(p) for p in parts)
+        P=max(1,min(self.workers or self.so.pool.threads,n//self.so.PAR_MIN or 1))
+        # as partes já estão ordenadas: o timsort (kind=stable) só as intercala
+        if len(parts)<=1: return parts[0] if parts else np.empty(0,self.dtype)
+        if P==1: return np.sort(np.concatenate(parts),kind="stable")
+        s=self.so.OVERSAMPLE
+        smp=np.sort(np.concatenate([p[np.linspace(0,len(p)-1,min(s,len(p))).astype(np.int64)] for p in parts]))
+        spl=smp[np.arange(1,P)*len(smp)//P]
+        bnd=[np.concatenate(([0],np.searchsorted(p,spl,side="right"),[len(p)])) for p in parts]
+        offs=np.concatenate(([0],np.cumsum(np.sum([b[1:]-b[:-1] for b in bnd],axis=0))))
+        out=np.empty(n,dtype=parts[0].dtype)
+        def merge(j): out[offs[j]:offs[j+1]]=np.sort(np.concatenate([p[b[j]:b[j+1]] for p,b in zip(parts,bnd)]),kind="stable")
+        self.so.pool.map(merge,range(P),workers=P)
+        self.metrics["parallel_slices"]+=P
+        return out
+
+    def merge(self):
+        """Gera a saída intercalada em blocos np.ndarray."""
+        K=len(self.src); m=self.metrics
+        io=ThreadPoolExecutor(max(1,min(self.prefetch_threads,K)),thread_name_prefix="nexus-prefetch")
+        buf:List[np.ndarray]=[np.empty(0,self.dtype)]*K; pos=[0]*K; last:List[Any]=[None]*K
+        prev=None; nan=0
+        def fetch(i):
+            t=time.perf_counter(); b=next(self.src[i],None)
+            return b,(time.perf_counter()-t)*1e6
+        def load(i):
+            # consome o bloco pré-lido e já pede o próximo; chave (0,último) ou (1,) se a run acabou
+            nonlocal nan
+            while fut[i] is not None:
+                t=time.perf_counter(); a,us=fut[i].result()
+                m["prefetch_wait_us"]+=(time.perf_counter()-t)*1e6; m["read_io_us"]+=us
+                if a is None: fut[i]=None; break
+                a=np.asarray(a)
+                if a.dtype!=self.dtype: a=a.astype(self.dtype)
+                m["bytes_read"]+=a.nbytes
+                if self.dtype.kind=="f":
+                    bad=np.isnan(a)
+                    if bad.any(): nan+=int(bad.sum()); a=a[~bad]
+                fut[i]=io.submit(fetch,i)
+                if not len(a): continue
+                if self.check and ((last[i] is not None and a[0]<last[i]) or bool(np.any(a[1:]<a[:-1]))):
+                    raise ValueError(f"Run {i} não está ordenada")
+                buf[i]=a; pos[i]=0; last[i]=a[-1]
+                return (0,a[-1])
+            buf[i]=np.empty(0,self.dtype); pos[i]=0
+            return (1,)
+        fut:List=[]
+        try:
+            fut=[io.submit(fetch,i) for i in range(K)]
+            tree=LoserTree([load(i) for i in range(K)]) if K else None
+            while tree is not None:
+                key=tree.keys[tree.winner()]
+                if key[0]: break
+                t=time.perf_counter(); parts=[]
+                for i in range(K):
+                    b=buf[i]
+                    if pos[i]>=len(b): continue
+                    e=pos[i]+int(np.searchsorted(b[pos[i]:],key[1],side="right"))
+                    if e>pos[i]: parts.append(b[pos[i]:e]); pos[i]=e
+                out=self._merge_parts(parts)
+                if self.dedup and len(out):
+                    keep=np.empty(len(out),dtype=bool); keep[1:]=out[1:]!=out[:-1]
+                    keep[0]=prev is None or out[0]!=prev
+                    m["duplicates_dropped"]+=int(len(out)-keep.sum()); prev=out[-1]; out=out[keep]
+                m["merge_cpu_us"]+=(time.perf_counter()-t)*1e6
+                if len(out): m["blocks_out"]+=1; m["output_size"]+=len(out); yield out
+                while True:
+                    w=tree.winner()
+                    if tree.keys[w][0] or pos[w]<len(buf[w]): break
+                    tree.replace(w,load(w))
+            m["nan"]=nan
+            if nan:
+                k=1 if self.dedup else nan
+                m["duplicates_dropped"]+=nan-k; m["output_size"]+=k; yield np.full(k,np.nan,dtype=self.dtype)
+        finally: io.shutdown(wait=True,cancel_futures=True)
+
+
+class ExternalSorter:
+    """Merge sort externo. Runs ordenadas (sample sort paralelo) em blocos
+    limitados pelo orçamento de memória vão para arquivos temporários e são
+    intercaladas em K vias pelo RunMerger, com blocos de mem/(2K+2) valores.
+    NaN não entra nas runs; sai no final."""
+    def __init__(self, dtype:str="float64", memory_bytes:int=256<<20,
+                 spill_dir:Optional[str]=None, sorter:Optional[SortEngine]=None, prefetch_threads:int=4):
+        self.dtype=np.dtype(dtype); self.mem=max(memory_bytes,1<<20)
+        self.so=sorter or SortEngine(); self.prefetch_threads=prefetch_threads
+        self.run_elems=max(1024,self.mem//(5*self.dtype.itemsize))   # pico ~4,6 runs: run, runs locais, saída e buckets do sample sort
+        self._dir=tempfile.mkdtemp(prefix="nexus-sort-",dir=spill_dir or tempfile.gettempdir())
+        self._rm=weakref.finalize(self,shutil.rmtree,self._dir,True)   # também se o merge nunca rodar
+        self._buf=[]; self._nbuf=0; self._runs=[]; self._nan=0; self.count=0
+        self.metrics={"runs":0,"run_elems":self.run_elems,"sort_cpu_us":0.0,"spill_io_us":0.0,
+                      "bytes_spilled":0,"fan_in":0,"block_elems":0,"blocks_out":0,"merge_cpu_us":0.0,
+                      "read_io_us":0.0,"prefetch_wait_us":0.0,"bytes_read":0}
+
+    def add(self, chunk:np.ndarray):
+        if chunk.dtype!=self.dtype: chunk=chunk.astype(self.dtype)
+        if self.dtype.kind=="f":
+            nan=np.isnan(chunk)
+            if nan.any(): self._nan+=int(nan.sum()); chunk=chunk[~nan]
+        self.count+=len(chunk)
+        while len(chunk):
+            take=min(len(chunk),self.run_elems-self._nbuf)
+            self._buf.append(chunk[:take]); self._nbuf+=take; chunk=chunk[take:]
+            if self._nbuf>=self.run_elems: self._spill()
+
+    def _sorted_buffer(self) -> np.ndarray:
+        t=time.perf_counter()
+        a=np.concatenate(self._buf) if self._buf else np.empty(0,self.dtype)
+        self._buf=[]; self._nbuf=0
+        a,_,_=self.so._sample_sort(a)
+        self.metrics["sort_cpu_us"]+=(time.perf_counter()-t)*1e6
+        return a
+
+    def _spill(self):
+        if not self._nbuf: return
+        a=self._sorted_buffer(); t=time.perf_counter()
+        path=os.path.join(self._dir,f"run{len(self._runs):05d}.bin")
+        a.tofile(path)
+        self.metrics["spill_io_us"]+=(time.perf_counter()-t)*1e6
+        self.metrics["bytes_spilled"]+=a.nbytes; self.metrics["runs"]+=1
+        self._runs.append((path,len(a)))
+
+    def merge(self, block_elems:int=0):
+        """Gera a saída ordenada em blocos np.ndarray e apaga os arquivos ao final."""
+        try:
+            if not self._runs:
+                a=self._sorted_buffer(); step=block_elems or 1<<16
+                for i in range(0,len(a),step): self.metrics["blocks_out"]+=1; yield a[i:i+step]
+            else:
+                self._spill(); yield from self._kway(block_elems)
+            if self._nan: yield np.full(self._nan,np.nan,dtype=self.dtype)
+        finally: self.cleanup()
+
+    def _kway(self, block_elems:int):
+        K=len(self._runs)
+        blk=block_elems or max(4096,self.mem//(self.dtype.itemsize*(2*K+2)))
+        self.metrics["block_elems"]=blk
+        src=[RunMerger.file_source(p,"binary",self.dtype.str,blk) for p,_ in self._runs]
+        yield from RunMerger(src,self.dtype,sorter=self.so,prefetch_threads=self.prefetch_threads,
+                             check=False,metrics=self.metrics).merge()
+
+    def cleanup(self): self._rm()
+
+
+def _bench_worker(conn, algorithm:str, cells:List[Tuple[str,int]], warmup:int, reps:int, seed:int):
+    """Processo isolado do SortBenchmark: mede cada célula (distribuição, n) e
+    envia o resultado assim que termina, para o pai poder cortar por tempo."""
+    se=SortEngine(); run,prep,probe=se._runner(algorithm)
+    fresh=lambda x:x[:] if isinstance(x,list) else x     # kernels didáticos ordenam no lugar
+    for dist,n in cells:
+        try:
+            x=prep(SortBenchmark.workload(dist,n,seed)); conn.send("tick")
+            for _ in range(warmup): run(fresh(x)); conn.send("tick")
+            ts=[]
+            for _ in range(reps):
+                y=fresh(x); t=time.perf_counter(); run(y); ts.append((time.perf_counter()-t)*1e6)
+                conn.send("tick")
+            pr=probe(fresh(x)) if probe else None; conn.send("tick")
+            conn.send((dist,n,"ok",ts,pr))
+        except Exception as e: conn.send((dist,n,"error",str(e),None))
+    conn.send(None)
+
+
+class SortBenchmark:
+    """Benchmark rigoroso: cargas geradas, aquecimento, repetições e um
+    processo por algoritmo com teto de tempo por célula. Um estouro mata o
+    processo e pula os tamanhos maiores daquela distribuição (O(n²) aborta
+    cedo sem travar o resto)."""
+    WORKLOADS=["uniform","sorted","reversed","organ_pipe","few_unique","zipf","nearly_sorted"]
+
+    @staticmethod
+    def workload(dist:str, n:int, seed:int=42) -> np.ndarray:
+        rng=np.random.default_rng(seed)
+        if dist=="uniform":    return rng.integers(0,1<<31,n,dtype=np.int64)
+        if dist=="sorted":     return np.arange(n,dtype=np.int64)
+        if dist=="reversed":   return np.arange(n,0,-1,dtype=np.int64)
+        if dist=="organ_pipe": return np.concatenate((np.arange(n//2),np.arange(n-n//2,0,-1))).astype(np.int64)
+        if dist=="few_unique": return rng.integers(0,16,n,dtype=np.int64)
+        if dist=="zipf":       return np.minimum(rng.zipf(1.5,n),1<<31).astype(np.int64)
+        if dist=="nearly_sorted":
+            a=np.arange(n,dtype=np.int64); k=max(1,n//100)
+            i,j=rng.integers(0,n,k),rng.integers(0,n,k); a[i],a[j]=a[j],a[i]
+            return a
+        raise ValueError(f"Distribuição inválida. Use: {SortBenchmark.WORKLOADS}")
+
+    @staticmethod
+    def _summary(ts:List[float]) -> Dict:
+        t=np.asarray(ts); med=float(np.median(t)); q1,q3=np.percentile(t,[25,75])
+        return {"median_us":round(med,4),"min_us":round(float(t.min()),4),"mean_us":round(float(t.mean()),4),
+                "iqr_us":round(float(q3-q1),4),"mad_us":round(float(np.median(np.abs(t-med))),4),
+                "cv":round(float(t.std()/t.mean()),4) if t.mean() else 0.0,"reps":len(ts)}
+
+    def run(self, algorithms:List[str], distributions:List[str], sizes:List[int], warmup:int=1,
+            repetitions:int=5, time_cap_s:float=10.0, seed:int=42) -> Dict:
+        import multiprocessing as mp
+        t0=time.perf_counter(); ctx=mp.get_context("spawn")
+        sizes=sorted(set(sizes)); res={a:{d:[] for d in distributions} for a in algorithms}
+        for algo in algorithms:
+            pending=[(d,n) for n in sizes for d in distributions]
+            while pending:
+                rx,tx=ctx.Pipe(duplex=False)
+                p=ctx.Process(target=_bench_worker,args=(tx,algo,pending,warmup,repetitions,seed),daemon=True)
+                p.start(); tx.close(); cut=None; respawn=False
+                while pending and not respawn:
+                    # o filho avisa a cada execução: silêncio além do teto (+ margem para
+                    # importar o NumPy e gerar a carga) significa uma execução longa demais
+                    if not rx.poll(time_cap_s+5): cut=pending[0]; break
+                    try: msg=rx.recv()
+                    except EOFError: cut=pending[0]; break
+                    if msg=="tick": continue
+                    if msg is None: break
+                    d,n,st,ts,cmps=msg; pending.remove((d,n))
+                    cell={"n":n,"status":st}
+                    if st=="ok":
+                        cell.update(self._summary(ts),**(cmps or {"comparisons":None}))
+                        if cell["median_us"]>time_cap_s*1e6: cell["status"]="timeout"
+                    else: cell["error"]=ts
+                    res[algo][d].append(cell)
+                    if cell["status"]=="timeout":
+                        # o filho segue a lista recebida na criação: troca de processo
+                        # para que ele não meça células descartadas e pending[0] continue
+                        # sendo a célula em execução
+                        pending=[c for c in pending if not(c[0]==d and c[1]>n)]; respawn=True
+                if p.is_alive(): p.terminate()
+                p.join(); rx.close()
+                if cut:
+                    d,n=cut; res[algo][d].append({"n":n,"status":"timeout"})
+                    pending=[c for c in pending if not(c[0]==d and c[1]>=n)]
+        scaling={}; fastest={}
+        for algo,by in res.items():
+            for d,cells in by.items():
+                ok=[c for c in cells if c["status"]=="ok" and c["median_us"]>0]
+                if len(ok)>=2:
+                    # expoente k de t ~ n^k: inclinação log-log por mínimos quadrados
+                    k=np.polyfit(np.log([c["n"] for c in ok]),np.log([c["median_us"] for c in ok]),1)[0]
+                    scaling.setdefault(algo,{})[d]=round(float(k),3)
+                for c in ok:
+                    f=fastest.setdefault(d,{}).setdefault(str(c["n"]),(algo,c["median_us"]))
+                    if c["median_us"]<f[1]: fastest[d][str(c["n"])]=(algo,c["median_us"])
+        return {"algorithms":algorithms,"distributions":distributions,"sizes":sizes,
+                "warmup":warmup,"repetitions":repetitions,"time_cap_s":time_cap_s,"seed":seed,
+                "results":res,"scaling_exponent":scaling,
+                "fastest":{d:{n:v[0] for n,v in by.items()} for d,by in fastest.items()},
+                "latency_us":round((time.perf_counter()-t0)*1e6,4)}
+
 
 # ══════════════════════════════════════════════════════════════════════════════
 #  6. PRIME ENGINE
 # ══════════════════════════════════════════════════════════════════════════════
+class PrimeTable:
+    """Tabela de primos do processo. Crivo de Eratóstenes segmentado com roda
+    mod 30: cada byte cobre 30 números e guarda um bit por resíduo coprimo com
+    30, então múltiplos de 2, 3 e 5 nem são representados. Cresce sob demanda
+    (ao menos dobrando) até NEXUS_PRIME_TABLE_MAX e é compartilhada por sieve,
+    goldbach, nth_prime e factorize: dentro da faixa já crivada, is_prime é um
+    bit e pi(x) é um prefixo por bloco mais um popcount de até BLOCK bytes."""
+    R=np.array([1,7,11,13,17,19,23,29],dtype=np.int64)
+    SEG_BYTES=1<<16     # segmento: 64 KiB empacotados (~2M números)
+    SMALL=1024          # primos até aqui riscam por fatia; acima, índices vetorizados
+    BLOCK=4096          # granularidade do prefixo de contagem
+    CHUNK=1<<16         # primos-base por lote no crivo de um segmento
+    _INV=np.zeros(30,dtype=np.int64); _IDX=np.full(30,-1,dtype=np.int64)
+    for _j,_r in enumerate(R.tolist()): _INV[_r]=pow(_r,-1,30); _IDX[_r]=_j
+    del _j,_r
+    _POP=np.array([bin(i).count("1") for i in range(256)],dtype=np.int64)
+
+    def __init__(self, max_limit:int=0, pool:Optional['WorkerPool']=None):
+        self.max_limit=max_limit or int(os.getenv("NEXUS_PRIME_TABLE_MAX",str(10**9)))
+        self.pool=pool; self._lock=threading.Lock()
+        self._st=(np.zeros(0,dtype=np.uint8),np.zeros(1,dtype=np.int64))   # (bits, contagem por bloco)
+        self.grows=0; self.sieve_us=0.0; self.mapped=None
+
+    @property
+    def limit(self) -> int: return 30*len(self._st[0])-1
+
+    @staticmethod
+    def _base(n:int) -> np.ndarray:
+        s=np.ones(n+1,dtype=bool); s[:2]=False
+        for i in range(2,math.isqrt(n)+1):
+            if s[i]: s[i*i::i]=False
+        return np.nonzero(s)[0]
+
+    @classmethod
+    def _segment(cls, B:int, S:int, ps:np.ndarray) -> np.ndarray:
+        """Crivo dos bytes [B, B+S): fl[b,j] <=> 30(B+b)+R[j] é primo."""
+        fl=np.ones((S,8),dtype=bool)
+        if B==0: fl[0,0]=False
+        ps=ps[(ps>=7)&(ps*ps<30*(B+S))]
+        # p·m ≡ R[j] (mod 30) <=> m ≡ R[j]·p⁻¹: em bytes, uma progressão de passo p por coluna;
+        # os primos vão em lotes para a memória não escalar com pi(sqrt(hi))
+        for c in range(0,len(ps),cls.CHUNK):
+            q=ps[c:c+cls.CHUNK]; P=q[:,None]; m0=(cls.R*cls._INV[q%30][:,None])%30
+            b0=(P*m0-cls.R)//30
+            t=np.maximum(np.maximum(0,-((m0-P)//30)),-((b0-B)//P))   # m >= p e byte >= B
+            st=b0+P*t-B
+            small=q<=cls.SMALL
+            for k in np.nonzero(small)[0]:
+                p=int(q[k])
+                for j in range(8):
+                    if st[k,j]<S: fl[st[k,j]::p,j]=False
+            if not small.all():
+                s=st[~small]; p=np.broadcast_to(P[~small],s.shape).ravel()
+                col=np.broadcast_to(np.arange(8),s.shape).ravel(); s=s.ravel()
+                cnt=np.where(s<S,(S-1-s)//p+1,0); tot=int(cnt.sum())
+                if tot:
+                    rep=np.repeat(np.arange(len(cnt)),cnt)
+                    fl[s[rep]+p[rep]*(np.arange(tot)-(np.cumsum(cnt)-cnt)[rep]),col[rep]]=False
+        return np.packbits(fl,axis=1,bitorder="little").ravel()
+
+    def ensure(self, n:int):
+        """Garante a tabela até n; devolve o snapshot (bits, contagem por bloco)."""
+        st=self._st
+        if n<=30*len(st[0])-1: return st
+        if n>self.max_limit: raise ValueError(f"Limite da tabela de primos: {self.max_limit} (NEXUS_PRIME_TABLE_MAX)")
+        with self._lock:
+            bits,cum=self._st; old=len(bits)
+            if n<=30*old-1: return self._st
+            t=time.perf_counter()
+            target=min(self.max_limit,max(n,2*(30*old),1<<20))
+            nb=-(-(target+1)//30); nb=-(-nb//self.BLOCK)*self.BLOCK
+            ps=self._base(math.isqrt(30*nb)+1)
+            seg=lambda B:self._segment(B,min(self.SEG_BYTES,nb-B),ps)
+            starts=range(old,nb,self.SEG_BYTES)
+            new=self.pool.map(seg,starts) if self.pool else list(map(seg,starts))
+            bits=np.concatenate([bits]+new)
+            add=np.cumsum(self._POP[bits[old:]].reshape(-1,self.BLOCK).sum(axis=1))+cum[-1]
+            self._st=(bits,np.concatenate((cum,add)))
+            self.grows+=1; self.sieve_us+=(time.perf_counter()-t)*1e6
+            return self._st
+
+    def contains(self, x):
+        """is_prime vetorizado sobre a tabela (escalar ou array)."""
+        a=np.asarray(x,dtype=np.int64)
+        bits,_=self.ensure(int(a.max()) if a.size else 0)
+        j=self._IDX[a%30]; ok=(j>=0)&(a>1)
+        out=np.zeros(a.shape,dtype=bool)
+        out[ok]=(bits[a[ok]//30]>>j[ok])&1==1
+        out|=(a==2)|(a==3)|(a==5)
+        return bool(out) if out.ndim==0 else out
+
+    def pi(self, x:int) -> int:
+        if x<2: return 0
+        bits,cum=self.ensure(x); q=(x+1)//30; b=q//self.BLOCK
+        n=int(cum[b])+int(self._POP[bits[b*self.BLOCK:q]].sum())+sum(1 for s in (2,3,5) if s<=x)
+        rem=x-30*q
+        if rem>=1: n+=int(self._POP[int(bits[q])&((1<<int(np.searchsorted(self.R,rem,side="right")))-1)])
+        return n
+
+    def primes(self, lo:int, hi:int) -> np.ndarray:
+        """Primos em [lo, hi]."""
+        if hi<max(lo,2): return np.zeros(0,dtype=np.int64)
+        bits,_=self.ensure(hi); b=max(lo,0)//30
+        k=np.nonzero(np.unpackbits(bits[b:hi//30+1],bitorder="little"))[0]
+        p=np.concatenate((np.array([2,3,5],dtype=np.int64),30*(b+(k>>3))+self.R[k&7]))
+        return p[(p>=lo)&(p<=hi)]
+
+    def nth(self, n:int) -> int:
+        if n<=3: return (2,3,5)[n-1]
+        ln=math.log(n); bits,cum=self.ensure(int(n*(ln+math.log(ln)))+1 if n>=6 else 13)
+        k=n-3; b=int(np.searchsorted(cum,k,side="left"))-1
+        idx=np.nonzero(np.unpackbits(bits[b*self.BLOCK:(b+1)*self.BLOCK],bitorder="little"))[0][k-int(cum[b])-1]
+        return int(30*(b*self.BLOCK+(idx>>3))+self.R[idx&7])
+
+    def iter_range(self, lo:int, hi:int, pool:Optional['WorkerPool']=None, workers:int=0):
+        """Primos de [lo, hi] em blocos crescentes, um segmento da roda por
+        bloco, sem crescer a tabela além de sqrt(hi). Com pool, rodadas de
+        segmentos vizinhos são crivadas em paralelo e emitidas em ordem."""
+        lo=max(lo,2)
+        if hi<lo: return
+        if hi<=self.limit:
+            for a in range(lo,hi+1,30*self.SEG_BYTES):
+                p=self.primes(a,min(hi,a+30*self.SEG_BYTES-1))
+                if len(p): yield p
+            return
+        small=np.array([q for q in (2,3,5) if lo<=q<=hi],dtype=np.int64)
+        if len(small): yield small
+        ps=self.primes(2,math.isqrt(hi)); b0,b1=lo//30,hi//30+1
+        def seg(B):
+            k=np.nonzero(np.unpackbits(self._segment(B,min(self.SEG_BYTES,b1-B),ps),bitorder="little"))[0]
+            p=30*(B+(k>>3))+self.R[k&7]
+            return p[(p>=lo)&(p<=hi)]
+        starts=list(range(b0,b1,self.SEG_BYTES))
+        W=max(1,min(workers or (pool.threads if pool else 1),pool.threads if pool else 1))
+        for g in range(0,len(starts),W):
+            for p in (pool.map(seg,starts[g:g+W],workers=W) if W>1 else map(seg,starts[g:g+W])):
+                if len(p): yield p
+
+    def count_range(self, lo:int, hi:int, pool:Optional['WorkerPool']=None, workers:int=0) -> Dict:
+        """Conta os primos de [lo, hi] espalhando os segmentos pelo pool. Cada
+        tarefa criva num buffer de bits próprio e devolve só a contagem (as
+        bordas da faixa são decodificadas); a soma segue a ordem dos segmentos,
+        então o resultado não depende do número de threads."""
+        lo=max(lo,2); t0=time.perf_counter()
+        W=max(1,min(workers or (pool.threads if pool else 1),pool.threads if pool else 1))
+        if hi<lo: return {"count":0,"segments":0,"workers":W,"seconds":0.0}
+        ps=self.primes(2,math.isqrt(hi)); b0,b1=lo//30,hi//30+1
+        def seg(B):
+            bits=self._segment(B,min(self.SEG_BYTES,b1-B),ps)
+            if 30*B>=lo and 30*(B+len(bits))-1<=hi: return int(self._POP[bits].sum())
+            k=np.nonzero(np.unpackbits(bits,bitorder="little"))[0]; p=30*(B+(k>>3))+self.R[k&7]
+            return int(((p>=lo)&(p<=hi)).sum())
+        starts=range(b0,b1,self.SEG_BYTES)
+        counts=pool.map(seg,starts,workers=W) if pool and W>1 else list(map(seg,starts))
+        dt=time.perf_counter()-t0
+        return {"count":sum(counts)+sum(1 for q in (2,3,5) if lo<=q<=hi),"segments":len(starts),"workers":W,
+                "seconds":round(dt,6),"segments_per_sec":round(len(starts)/dt,2) if dt else None,
+                "numbers_per_sec":round((hi-lo+1)/dt,2) if dt else None}
+
+    def sieve_range(self, lo:int, hi:int) -> np.ndarray:
+        """Primos em [lo, hi] materializados (faixas curtas)."""
+        return np.concatenate([np.zeros(0,dtype=np.int64)]+list(self.iter_range(lo,hi)))
+
+    # Arquivo: cabeçalho de 64 bytes (MAGIC, nº de bytes da roda, BLOCK, nº de
+    # prefixos), os bits e a contagem por bloco em int64 alinhada a 8 bytes.
+    # Tudo little-endian, para ser mapeado direto por np.memmap.
+    MAGIC=b"NXPTAB01"; _HDR=struct.Struct("<8sQQQ"); HDR_BYTES=64
+
+    def save(self, path:str) -> Dict:
+        """Grava a tabela atual em path (escrita num temporário e os.replace,
+        então leitores e outros processos nunca veem um arquivo pela metade)."""
+        bits,cum=self._st; off=-(-(self.HDR_BYTES+len(bits))//8)*8
+        tmp=f"{path}.{os.getpid()}.tmp"
+        with open(tmp,"wb") as f:
+            f.write(self._HDR.pack(self.MAGIC,len(bits),self.BLOCK,len(cum)).ljust(self.HDR_BYTES,b"\0"))
+            f.write(np.asarray(bits,dtype=np.uint8).tobytes()); f.write(b"\0"*(off-self.HDR_BYTES-len(bits)))
+            f.write(np.asarray(cum,dtype="<i8").tobytes())
+        os.replace(tmp,path)
+        return {"path":path,"limit":max(30*len(bits)-1,0),"bytes":off+8*len(cum)}
+
+    @classmethod
+    def stored_limit(cls, path:str) -> int:
+        """Limite coberto pelo arquivo em path (-1 se ausente ou inválido)."""
+        try:
+            with open(path,"rb") as f: magic,nb,_,_=cls._HDR.unpack_from(f.read(cls.HDR_BYTES))
+        except (OSError,struct.error): return -1
+        return 30*nb-1 if magic==cls.MAGIC else -1
+
+    def load(self, path:str) -> bool:
+        """Mapeia path somente-leitura no lugar da tabela, se cobrir mais que a
+        atual. As páginas ficam no page cache e são compartilhadas por todos os
+        processos que mapeiam o mesmo arquivo; crescer além dele copia a tabela
+        para a memória do processo."""
+        with open(path,"rb") as f: h=f.read(self.HDR_BYTES)
+        if len(h)<self.HDR_BYTES: raise ValueError(f"{path}: arquivo de tabela truncado")
+        magic,nb,block,nc=self._HDR.unpack_from(h)
+        off=-(-(self.HDR_BYTES+nb)//8)*8
+        if magic!=self.MAGIC or block!=self.BLOCK or nb%block or nc!=nb//block+1 or os.path.getsize(path)!=off+8*nc:
+            raise ValueError(f"{path}: não é uma tabela de primos compatível")
+        with self._lock:
+            if nb<=len(self._st[0]): return False
+            self._st=(np.memmap(path,dtype=np.uint8,mode="r",offset=self.HDR_BYTES,shape=(nb,)),
+                      np.memmap(path,dtype="<i8",mode="r",offset=off,shape=(nc,)))
+            self.mapped=path
+        return True
+
+    def info(self) -> Dict:
+        bits,cum=self._st
+        return {"limit":max(self.limit,0),"bytes":int(bits.nbytes+cum.nbytes),"primes":int(cum[-1])+3*(len(bits)>0),
+                "grows":self.grows,"sieve_us":round(self.sieve_us,4),"max_limit":self.max_limit,
+                "mapped":self.mapped if isinstance(bits,np.memmap) else None}
+
+
+PRIME_TABLE=PrimeTable()
+
+
 class PrimeEngine:
+    TRIAL_MAX=1<<16     # divisão por tentativa pela tabela; cofatores < TRIAL_MAX² já são primos
+    SIEVE_LIST_MAX=100000
+
+    RANGE_MAX=10**18    # primos-base até 1e9 vêm da tabela
+
+    def __init__(self, pool:'WorkerPool'=None, table:Optional[PrimeTable]=None):
+        self.pool=pool or WorkerPool(); self.table=table or PRIME_TABLE
+        if self.table.pool is None: self.table.pool=self.pool
+
+    MR_BASES_32=(2,7,61)                                      # determinístico para n < 4 759 123 141
+    MR_BASES_64=(2,325,9375,28178,450775,9780504,1795265022)   # determinístico para n < 2^64
+    SMALL_PRIMES=(2,3,5,7,11,13,17,19,23,29,31,37,41,43,47,53,59,61,67,71)
+
+    @staticmethod
+    def _strong_prp(n:int, a:int) -> bool:
+        """Miller-Rabin numa base: n-1 = d·2^s."""
+        a%=n
+        if a==0: return True
+        d=n-1; s=(d&-d).bit_length()-1; d>>=s
+        x=pow(a,d,n)
+        if x==1 or x==n-1: return True
+        for _ in range(s-1):
+            x=x*x%n
+            if x==n-1: return True
+        return False
+
+    @staticmethod
+    def _jacobi(a:int, n:int) -> int:
+        a%=n; r=1
+        while a:
+            while a%2==0:
+                a//=2
+                if n%8 in (3,5): r=-r
+            a,n=n,a
+            if a%4==3 and n%4==3: r=-r
+            a%=n
+        return r if n==1 else 0
+
+    def _strong_lucas_prp(self, n:int) -> bool:
+        """Lucas forte com parâmetros de Selfridge (método A): D é o primeiro
+        de 5,-7,9,-11,... com (D/n)=-1, P=1, Q=(1-D)/4."""
+        if math.isqrt(n)**2==n: return False
+        D=5
+        while True:
+            j=self._jacobi(D,n)
+            if j==-1: break
+            if j==0 and abs(D)!=n: return False
+            D=-D-2 if D>0 else -D+2
+        Q=(1-D)//4; d=n+1; s=(d&-d).bit_length()-1; d>>=s
+        half=lambda x:(x+n if x&1 else x)//2%n
+        U,V,Qk=1,1,Q%n
+        for bit in bin(d)[3:]:
+            U,V,Qk=U*V%n,(V*V-2*Qk)%n,Qk*Qk%n
+            if bit=="1": U,V,Qk=half(U+V),half(D*U+V),Qk*Q%n
+        if U==0 or V==0: return True
+        for _ in range(s-1):
+            V,Qk=(V*V-2*Qk)%n,Qk*Qk%n
+            if V==0: return True
+        return False
+
+    def primality(self, n:int, rounds:int=0) -> Dict:
+        """Tabela (se coberto), Miller-Rabin determinístico abaixo de 2^64 e
+        BPSW acima, com rounds bases aleatórias extras de Miller-Rabin."""
+        if n<=self.table.limit: return {"is_prime":self.table.contains(n),"method":"table","deterministic":True}
+        for p in self.SMALL_PRIMES:
+            if n%p==0: return {"is_prime":n==p,"method":"trial","deterministic":True}
+        if n<1<<64:
+            bases=self.MR_BASES_32 if n<4759123141 else self.MR_BASES_64
+            return {"is_prime":all(self._strong_prp(n,a) for a in bases),"method":"miller_rabin_64","deterministic":True}
+        if gmpy2 is not None:
+            ok=bool(gmpy2.is_strong_bpsw_prp(n)) and all(gmpy2.is_strong_prp(n,random.randrange(3,n-1)) for _ in range(rounds))
+            return {"is_prime":ok,"method":"bpsw_gmp","deterministic":False,"mr_rounds":rounds}
+        ok=self._strong_prp(n,2) and self._strong_lucas_prp(n) and all(self._strong_prp(n,random.randrange(3,n-1)) for _ in range(rounds))
+        return {"is_prime":ok,"method":"bpsw","deterministic":False,"mr_rounds":rounds}
+
     def is_prime(self,n:int)->bool:
         if n<2: return False
-        if n<4: return True
-        if n%2==0 or n%3==0: return False
-        i=5
-        while i*i<=n:
-            if n%i==0 or n%(i+2)==0: return False
-            i+=6
-        return True
+        return self.primality(n)["is_prime"]
+
+    # ── Lote vetorizado (uint64) ─────────────────────────────────────────────
+    # mulmod de 64 bits sem inteiro de 128: o quociente vem do long double
+    # (mantissa de 64 bits no x86) e o resto é corrigido em uint64. Vale para
+    # n < 2^62; acima disso, ou sem long double estendido, cai no caminho escalar.
+    _LD_OK=np.finfo(np.longdouble).nmant>=63
+    VEC_MAX=1<<62 if _LD_OK else 1<<32
+    BATCH_CHUNK=1<<16
+    BATCH_TABLE=1<<24   # valores até aqui saem direto do bitset
+
+    @staticmethod
+    def _mulmod(a:np.ndarray, b:np.ndarray, n:np.ndarray) -> np.ndarray:
+        if not len(n) or int(n.max())<1<<32: return a*b%n
+        q=np.floor(a.astype(np.longdouble)*b.astype(np.longdouble)/n.astype(np.longdouble)).astype(np.uint64)
+        r=(a*b-q*n).view(np.int64); s=n.view(np.int64)
+        r=np.where(r<0,r+s,r); r=np.where(r>=s,r-s,r)
+        return r.view(np.uint64)
+
+    def _powmod_vec(self, b:np.ndarray, e:np.ndarray, n:np.ndarray) -> np.ndarray:
+        r=np.ones_like(n); b=b%n
+        for i in range(int(e.max()).bit_length()):
+            bit=(e>>np.uint64(i))&np.uint64(1)==1
+            if bit.any(): r=np.where(bit,self._mulmod(r,b,n),r)
+            b=self._mulmod(b,b,n)
+        return r
+
+    def _mr_vec(self, n:np.ndarray) -> np.ndarray:
+        """Miller-Rabin determinístico em lanes (n ímpar, 71 < n < VEC_MAX);
+        lanes reprovadas saem do conjunto ativo a cada base."""
+        alive=np.ones(len(n),dtype=bool)
+        d=n-np.uint64(1); low=d&(~d+np.uint64(1))
+        s=np.log2(low.astype(np.float64)).astype(np.int64); d=d>>s.astype(np.uint64)
+        bases=self.MR_BASES_32 if len(n) and int(n.max())<4759123141 else self.MR_BASES_64
+        for a in bases:
+            i=np.nonzero(alive)[0]
+            if not len(i): break
+            m=n[i]; x=self._powmod_vec(np.full(len(i),a,dtype=np.uint64),d[i],m)
+            m1=m-np.uint64(1); ok=(x==1)|(x==m1)|(np.uint64(a)%m==0); si=s[i]
+            for r in range(1,int(si.max())):
+                x=self._mulmod(x,x,m); ok|=(x==m1)&(r<si)
+            alive[i]=ok
+        return alive
+
+    def _is_prime_chunk(self, a:np.ndarray) -> np.ndarray:
+        out=np.zeros(len(a),dtype=bool); lim=self.table.limit
+        t=a<=lim
+        if t.any(): out[t]=self.table.contains(a[t].astype(np.int64))
+        rest=np.nonzero(~t)[0]
+        if not len(rest): return out
+        v=a[rest]; keep=np.ones(len(v),dtype=bool)
+        for p in self.SMALL_PRIMES: keep&=v%np.uint64(p)!=0
+        rest=rest[keep]; v=v[keep]
+        vec=v<self.VEC_MAX
+        if vec.any(): out[rest[vec]]=self._mr_vec(v[vec])
+        for j in np.nonzero(~vec)[0]: out[rest[j]]=self.is_prime(int(v[j]))
+        return out
+
+    def is_prime_batch(self, a:np.ndarray, workers:int=0) -> np.ndarray:
+        """is_prime sobre um array uint64: bitset da tabela para os pequenos,
+        Miller-Rabin vetorizado para o resto; blocos em paralelo no pool."""
+        a=np.asarray(a,dtype=np.uint64)
+        if not len(a): return np.zeros(0,dtype=bool)
+        self.table.ensure(min(int(a.max()),self.BATCH_TABLE))
+        cuts=range(0,len(a),self.BATCH_CHUNK)
+        return np.concatenate(self.pool.map(lambda i:self._is_prime_chunk(a[i:i+self.BATCH_CHUNK]),cuts,workers=workers))
+
+    def _rho_vec(self, n:np.ndarray, rng) -> np.ndarray:
+        """Pollard-Brent em lanes (n compostos ímpares < VEC_MAX): mesmo r para
+        todas, GCD em lote a cada 64 passos, lanes resolvidas são compactadas.
+        Devolve o divisor achado por lane (0 = não achou; vai para o escalar)."""
+        out=np.zeros(len(n),dtype=np.uint64); idx=np.arange(len(n))
+        y=(rng.integers(1,2**62,len(n),dtype=np.uint64))%n; c=(rng.integers(1,2**62,len(n),dtype=np.uint64))%n
+        q=np.ones_like(n); r=1
+        f=lambda v,m,cc:(self._mulmod(v,v,m)+cc)%m
+        while len(idx) and r<=1<<20:
+            x=y.copy()
+            for _ in range(r): y=f(y,n,c)
+            k=0
+            while k<r and len(idx):
+                ys=y.copy()
+                for _ in range(min(64,r-k)):
+                    y=f(y,n,c); q=self._mulmod(q,np.where(x>y,x-y,y-x),n)
+                g=np.gcd(q,n); k+=64
+                hit=g>1
+                if hit.any():
+                    # g == n: refaz passo a passo a partir de ys para separar o fator
+                    for j in np.nonzero(hit&(g==n))[0]:
+                        m=int(n[j]); cc=int(c[j]); z=int(ys[j]); xx=int(x[j]); gg=m
+                        for _ in range(64):
+                            z=(z*z+cc)%m; gg=math.gcd(abs(xx-z),m)
+                            if gg>1: break
+                        g[j]=gg if gg<m else 0
+                    out[idx[hit]]=g[hit]
+                    keep=~hit; idx,n,x,y,c,q=idx[keep],n[keep],x[keep],y[keep],c[keep],q[keep]
+            r*=2
+        return out
+
+    def factorize_batch(self, a:np.ndarray, workers:int=0) -> Tuple[np.ndarray,np.ndarray,np.ndarray]:
+        """Fatora um array uint64; devolve (offsets, fatores, incompletos) em CSR:
+        os fatores de a[i] (crescentes, com repetição) são fatores[offsets[i]:offsets[i+1]]
+        e o produto sempre volta a a[i]. Se o prazo da fatoração escalar estoura,
+        o cofator composto entra como fator e i vai para incompletos."""
+        a=np.asarray(a,dtype=np.uint64); rng=np.random.default_rng(len(a))
+        fi,fv,inc=[],[],[]                           # pares (índice, fator); lanes incompletas
+        m=a.copy(); idx=np.arange(len(a))
+        for p in self.table.primes(2,1024).tolist():
+            P=np.uint64(p)
+            while True:
+                h=(m%P==0)&(m>1)
+                if not h.any(): break
+                fi.append(idx[h]); fv.append(np.full(int(h.sum()),p,dtype=np.uint64)); m[h]//=P
+        keep=m>1; idx,m=idx[keep],m[keep]
+        while len(m):
+            pr=(m<1<<20)|self.is_prime_batch(m,workers)     # sem fator <= 1024 e < 1024² => primo
+            fi.append(idx[pr]); fv.append(m[pr]); idx,m=idx[~pr],m[~pr]
+            if not len(m): break
+            vec=m<self.VEC_MAX; d=np.zeros(len(m),dtype=np.uint64)
+            if vec.any(): d[vec]=self._rho_vec(m[vec],rng)
+            for j in np.nonzero(d==0)[0]:             # escalar: fora do vetorizado ou lane sem sorte
+                r=self.factorize(int(m[j])); fs=r["factors"]+r.get("unfactored",[])
+                if not r["complete"]: inc.append(int(idx[j]))
+                fi.append(np.full(len(fs),idx[j])); fv.append(np.array(fs,dtype=np.uint64))
+            ok=d>0
+            idx=np.concatenate((idx[ok],idx[ok])); m=np.concatenate((d[ok],m[ok]//d[ok]))
+        fi=np.concatenate([np.zeros(0,dtype=np.int64)]+[np.asarray(x,dtype=np.int64) for x in fi])
+        fv=np.concatenate([np.zeros(0,dtype=np.uint64)]+fv)
+        o=np.lexsort((fv,fi)); fi,fv=fi[o],fv[o]
+        offsets=np.concatenate(([0],np.cumsum(np.bincount(fi,minlength=len(a))))).astype(np.int64)
+        return offsets,fv,np.unique(np.array(inc,dtype=np.int64))
 
     def sieve(self,limit:int)->List[int]:
-        if limit<2: return []
-        sieve=[True]*(limit+1); sieve[0]=sieve[1]=False
-        for i in range(2,int(limit**.5)+1):
-            if sieve[i]:
-                for j in range(i*i,limit+1,i): sieve[j]=False
-        return [i for i in range(2,limit+1) if sieve[i]]
-
-    def factorize(self,n:int)->Dict:
+        return self.table.primes(2,limit).tolist()
+
+    @staticmethod
+    def _divide(m:int, ds:np.ndarray, factors:List[int]) -> int:
+        r=m%ds if m<2**63 else np.array(m%ds.astype(object),dtype=np.int64)
+        for d in ds[r==0].tolist():
+            while m%d==0: factors.append(d); m//=d
+        return m
+
+    # ── Fatoração em camadas ──────────────────────────────────────────────────
+    # tentativa (tabela) → Pollard-Brent → SQUFOF (< 2^62) → ECM, com teste de
+    # primalidade entre as etapas e prazo global em ms
+    ECM_LEVELS=((2000,25),(11000,90),(50000,300),(250000,700))   # (B1, curvas) ~ 15/20/25/30 dígitos
+    SQUFOF_K=(1,3,5,7,11,15,21,33,35,55,77,105,165,231,385,1155)
+
+    @staticmethod
+    def _iroot(m:int, k:int) -> int:
+        x=1<<-(-m.bit_length()//k)
+        while True:
+            y=((k-1)*x+m//x**(k-1))//k
+            if y>=x: return x
+            x=y
+
+    @staticmethod
+    def _rho(n:int, rng, deadline:float, max_iter:int, tel:Dict) -> int:
+        """Pollard-Brent: f(x)=x²+c, GCD em lote a cada 128 passos, com backtrack."""
+        while time.perf_counter()<deadline:
+            y=rng.randrange(1,n); c=rng.randrange(1,n); g=q=r=1; x=ys=0; it=0
+            while g==1:
+                x=y
+                for _ in range(r): y=(y*y+c)%n
+                k=0
+                while k<r and g==1:
+                    ys=y
+                    for _ in range(min(128,r-k)): y=(y*y+c)%n; q=q*abs(x-y)%n
+                    g=math.gcd(q,n); k+=128; it+=128
+                r*=2
+                if it>max_iter or time.perf_counter()>deadline: tel["iterations"]+=it; return 0
+            tel["iterations"]+=it
+            if g==n:
+                while True:
+                    ys=(ys*ys+c)%n; g=math.gcd(abs(x-ys),n)
+                    if g>1: break
+            if g!=n: return g
+        return 0
+
+    def _squfof(self, n:int) -> int:
+        s=math.isqrt(n)
+        if s*s==n: return s
+        for k in self.SQUFOF_K:
+            D=k*n; P0=Pp=P=math.isqrt(D); Qp=1; Q=D-P0*P0
+            if Q==0:
+                g=math.gcd(n,P0)
+                if 1<g<n: return g
+                continue
+            B=6*math.isqrt(2*math.isqrt(D)); r=0
+            for i in range(2,B):
+                b=(P0+P)//Q; P=b*Q-P; q=Q; Q=Qp+b*(Pp-P); r=math.isqrt(Q)
+                if not i&1 and r*r==Q: break
+                Qp=q; Pp=P
+            else: continue
+            b=(P0-P)//r; Pp=P=b*r+P; Qp=r; Q=(D-Pp*Pp)//Qp
+            while True:
+                b=(P0+P)//Q; Pp=P; P=b*Q-P; q=Q; Q=Qp+b*(Pp-P); Qp=q
+                if P==Pp: break
+            g=math.gcd(n,P)
+            if 1<g<n: return g
+        return 0
+
+    def _ecm(self, n:int, rng, deadline:float, tel:Dict) -> int:
+        """ECM de Lenstra em curvas de Montgomery (parametrização de Suyama):
+        fase 1 com escada x/z até B1, fase 2 com passo D=2310 até B2=100·B1."""
+        def dbl(X,Z):
+            s=(X+Z)*(X+Z)%n; d=(X-Z)*(X-Z)%n; t=s-d
+            return s*d%n,t*(d+a24*t)%n
+        def add(X1,Z1,X2,Z2,Xd,Zd):
+            u=(X1-Z1)*(X2+Z2); v=(X1+Z1)*(X2-Z2)
+            return Zd*(u+v)**2%n,Xd*(u-v)**2%n
+        def mul(k,X,Z):
+            R0,R1=(X,Z),dbl(X,Z)
+            for bit in bin(k)[3:]:
+                if bit=="1": R0=add(*R0,*R1,X,Z); R1=dbl(*R1)
+                else: R1=add(*R0,*R1,X,Z); R0=dbl(*R0)
+            return R0
+        D=2310
+        for B1,curves in self.ECM_LEVELS:
+            B2=100*B1; ps=self.table.primes(2,B2).tolist()
+            base=[p for p in ps if p<=B1]; hi=[p for p in ps if p>B1]
+            baby=[d for d in range(1,D//2,2) if math.gcd(d,D)==1]
+            for _ in range(curves):
+                if time.perf_counter()>deadline: return 0
+                tel["curves"]+=1; tel["b1"]=B1
+                sg=rng.randrange(6,n-1); u=(sg*sg-5)%n; v=4*sg%n
+                X,Z=pow(u,3,n),pow(v,3,n)
+                num=pow(v-u,3,n)*(3*u+v)%n; den=16*pow(u,3,n)*v%n
+                g=math.gcd(den,n)
+                if g!=1:
+                    if g!=n: return g
+                    continue
+                a24=num*pow(den,-1,n)%n
+                for p in base:
+                    e=p
+                    while e*p<=B1: e*=p
+                    X,Z=mul(e,X,Z)
+                g=math.gcd(Z,n)
+                if 1<g<n: return g
+                if g==n: continue
+                # fase 2: q = mD ± d com d da tabela de bebês; acumula X_T·Z_d - X_d·Z_T
+                S={d:mul(d,X,Z) for d in baby}
+                DQ=mul(D,X,Z); m0=B1//D; Tp=mul(max(m0-1,1)*D,X,Z) if m0>1 else None
+                T=mul(m0*D,X,Z) if m0 else DQ; m=m0 or 1
+                acc=1; j=0
+                while j<len(hi):
+                    while j<len(hi) and hi[j]<=m*D+D//2:
+                        d=abs(hi[j]-m*D); Xd,Zd=S[d]; acc=acc*(T[0]*Zd-Xd*T[1])%n; j+=1
+                    Tn=add(*T,*DQ,*Tp) if Tp else dbl(*DQ)
+                    Tp,T=T,Tn; m+=1
+                g=math.gcd(acc,n)
+                if 1<g<n: return g
+        return 0
+
+    def factorize(self, n:int, budget_ms:int=5000) -> Dict:
         if n<2: return {"factors":[],"is_prime":False}
-        factors=[]; d=2
-        while d*d<=n:
-            while n%d==0: factors.append(d); n//=d
-            d+=1
-        if n>1: factors.append(n)
+        t0=time.perf_counter(); deadline=t0+budget_ms/1000; rng=random.Random(n)
+        tel={"trial":{"us":0.0,"found":0},"rho":{"us":0.0,"calls":0,"iterations":0,"found":0},
+             "squfof":{"us":0.0,"calls":0,"found":0},"ecm":{"us":0.0,"curves":0,"b1":0,"found":0},
+             "primality":{"us":0.0,"calls":0}}
+        factors=[]; m=n; top=min(math.isqrt(n),self.TRIAL_MAX)
+        if top>=2:
+            ps=self.table.primes(2,top); m=self._divide(m,ps,factors)
+        tel["trial"]["found"]=len(factors); tel["trial"]["us"]=(time.perf_counter()-t0)*1e6
+        stack=[m] if m>1 else []; left=[]
+        while stack:
+            m=stack.pop(); t=time.perf_counter()
+            pr=m<=self.TRIAL_MAX**2 or self.is_prime(m)
+            tel["primality"]["calls"]+=1; tel["primality"]["us"]+=(time.perf_counter()-t)*1e6
+            if pr: factors.append(m); continue
+            d=0
+            for k in range(2,m.bit_length()//16+1):
+                r=self._iroot(m,k)
+                if r**k==m: d=r; break
+            if d: stack.extend([d]*k); continue
+            for stage in ("rho","squfof","ecm"):
+                if time.perf_counter()>deadline: break
+                if stage=="squfof" and m.bit_length()>62: continue
+                t=time.perf_counter(); s=tel[stage]
+                if stage=="rho":
+                    s["calls"]+=1
+                    d=self._rho(m,rng,deadline,1<<30 if m.bit_length()<=64 else 1<<16,s)
+                elif stage=="squfof": s["calls"]+=1; d=self._squfof(m)
+                else: d=self._ecm(m,rng,deadline,s)
+                s["us"]+=(time.perf_counter()-t)*1e6
+                if d: s["found"]+=1; break
+            if d: stack.extend([d,m//d])
+            else: left.append(m)
+        factors.sort()
         from collections import Counter
         counts=dict(Counter(factors))
-        return {"factors":factors,"factorization":counts,"is_prime":len(factors)==1}
+        for s in tel.values(): s["us"]=round(s["us"],4)
+        r={"factors":factors,"factorization":counts,"is_prime":len(factors)==1 and not left,
+           "complete":not left,"stages":tel}
+        if left: r["unfactored"]=left
+        return r
 
     def goldbach(self,n:int)->Dict:
-        """Conjectura de Goldbach: n par = soma de 2 primos."""
+        """Conjectura de Goldbach: n par = soma de 2 primos. total_pairs conta os
+        pares listados (até 5); pair_count é r(n)/2, o total de pares p <= n-p."""
         if n<4 or n%2!=0: return {"error":"n deve ser um número par >= 4"}
-        primes=set(self.sieve(n))
-        pairs=[]
-        for p in range(2,n//2+1):
-            if p in primes and(n-p) in primes:
-                pairs.append([p,n-p])
-                if len(pairs)>=5: break
-        return {"n":n,"pairs":pairs,"total_pairs":len(pairs)}
+        ps=self.table.primes(2,n//2)
+        ps=ps[self.table.contains(n-ps)]
+        pairs=[[p,n-p] for p in ps[:5].tolist()]
+        return {"n":n,"pairs":pairs,"total_pairs":len(pairs),"pair_count":len(ps)}
+
+    GOLDBACH_MAX=5*10**7
+
+    def goldbach_counts(self, N:int, workers:int=0) -> np.ndarray:
+        """r(n) = nº de pares p <= q primos com p+q = n, para todo n par <= N
+        (posição n//2), numa convolução do indicador dos ímpares primos consigo
+        mesmo. O indicador é cortado em W blocos: as FFTs dos blocos e depois
+        as diagonais i+j = d (produtos somados, uma iFFT cada) rodam no pool;
+        a soma das diagonais segue a ordem, então o resultado não depende de W."""
+        if N<4 or N>self.GOLDBACH_MAX: raise ValueError(f"n deve estar em [4, {self.GOLDBACH_MAX}]")
+        M=N//2; self.table.ensure(N)
+        b=np.zeros(M,dtype=np.float64); b[(self.table.primes(3,2*M-1)-1)//2]=1.0   # b[k]: 2k+1 é primo
+        W=max(1,min(workers or self.pool.threads,self.pool.threads) if self.pool else 1)
+        K=min(W,max(1,M>>16)); B=-(-M//K); L=1<<(2*B-1).bit_length()
+        pm=(lambda f,it: self.pool.map(f,it,workers=W)) if self.pool and K>1 else (lambda f,it: list(map(f,it)))
+        F=pm(lambda i: np.fft.rfft(b[i*B:(i+1)*B],L),range(K))
+        def diag(d):
+            acc=None
+            for i in range(max(0,d-K+1),d//2+1):
+                t=F[i]*F[d-i]*(1.0 if 2*i==d else 2.0)
+                acc=t if acc is None else acc+t
+            return np.fft.irfft(acc,L)[:2*B-1]
+        c=np.zeros(K*B*2,dtype=np.float64)
+        for d,y in enumerate(pm(diag,range(2*K-1))): c[d*B:d*B+len(y)]+=y
+        c=np.rint(c[:M]).astype(np.int64)          # c[s]: pares ordenados (2i+1)+(2j+1) = 2(s+1)
+        c[::2]+=b[:(M+1)//2].astype(np.int64)        # p = q conta uma vez só
+        r=np.zeros(M+1,dtype=np.uint32); r[3:]=c[2:M]//2
+        if M>=2: r[2]=1                              # 4 = 2+2
+        return r
+
+    PI_MAX=10**13        # Lucy/Meissel em O(x^(3/4)): ~20 s em 1e13
+    NTH_TABLE_MAX=1<<26  # até aqui nth_prime cresce a tabela; acima, estimativa + pi(x) + crivo
+
+    def iter_range(self, lo:int, hi:int, workers:int=0):
+        """Primos de [lo, hi] em blocos, para consumo em streaming."""
+        if hi>self.RANGE_MAX: raise ValueError(f"hi deve ser <= {self.RANGE_MAX}")
+        self.table.ensure(math.isqrt(hi))       # falha aqui, antes do streaming começar
+        if (hi-lo)*64<self.table.pi(math.isqrt(hi))*30: return self._mr_range(lo,hi)
+        return self.table.iter_range(lo,hi,self.pool,workers)
+
+    def _mr_range(self, lo:int, hi:int):
+        """Janela estreita perto de hi grande: testar os candidatos da roda com
+        Miller-Rabin custa menos que varrer todos os primos-base até sqrt(hi)."""
+        for a in range(max(lo,2)//30*30,hi+1,30<<12):
+            c=(np.arange(a,min(a+(30<<12),hi+30),30,dtype=np.int64)[:,None]+PrimeTable.R).ravel()
+            c=[x for x in c[(c>=lo)&(c<=hi)].tolist() if self.is_prime(x)]
+            if a<=5: c=[q for q in (2,3,5) if lo<=q<=hi]+c
+            if c: yield np.array(c,dtype=np.int64)
+
+    COUNT_SPAN_MAX=10**11
+
+    def count_range(self, lo:int, hi:int, workers:int=0, scaling:bool=False) -> Dict:
+        """Contagem paralela em [lo, hi]; com scaling=True repete com 1, 2, 4…
+        threads até o tamanho do pool e relata speedup e vazão por rodada."""
+        if hi>self.RANGE_MAX: raise ValueError(f"hi deve ser <= {self.RANGE_MAX}")
+        if hi-lo>self.COUNT_SPAN_MAX: raise ValueError(f"Faixa máxima: {self.COUNT_SPAN_MAX} números")
+        self.table.ensure(math.isqrt(hi))
+        if not scaling: return self.table.count_range(lo,hi,self.pool,workers)
+        ws=sorted({1,self.pool.threads}|{1<<i for i in range(self.pool.threads.bit_length()) if 1<<i<=self.pool.threads})
+        runs=[self.table.count_range(lo,hi,self.pool,w) for w in ws]
+        base=runs[0]["seconds"]
+        for r in runs: r["speedup"]=round(base/r["seconds"],3) if r["seconds"] else None
+        if len({r["count"] for r in runs})!=1: raise RuntimeError("Contagens divergentes entre rodadas")
+        return {"count":runs[0]["count"],"lo":lo,"hi":hi,"scaling":runs}
+
+    def prime_pi(self, x:int) -> int:
+        """pi(x): da tabela se já coberto; senão recorrência de Legendre/Meissel
+        no estilo de Lucy sobre os valores x//i (2·sqrt(x) contadores), com
+        fatias NumPy por primo até sqrt(x)."""
+        if x<2: return 0
+        if x<=self.table.limit: return self.table.pi(x)
+        if x>self.PI_MAX: raise ValueError(f"pi(x) suportado até {self.PI_MAX}")
+        r=math.isqrt(x); i=np.arange(1,r+1,dtype=np.int64)
+        L=x//i-1                                            # L[i-1] = S(x//i)
+        Sm=np.arange(-1,r,dtype=np.int64); Sm[0]=0          # Sm[v]  = S(v)
+        for p in self.table.primes(2,r).tolist():
+            sp=int(Sm[p-1]); p2=p*p; k=min(r,x//p2)
+            # S(v) -= S(v//p) - S(p-1) para todo v >= p²; os lados direitos são os valores antigos
+            k1=min(k,r//p)
+            L[:k1]-=L[p-1:k1*p:p]-sp
+            if k>k1: L[k1:k]-=Sm[x//(i[k1:k]*p)]-sp
+            if p2<=r: Sm[r:p2-1:-1]-=Sm[i[r-1:p2-2:-1]//p]-sp
+        return int(L[0])
 
     def nth_prime(self,n:int)->int:
         if n<1: return 2
-        count=0; num=1
-        while count<n:
-            num+=1
-            if self.is_prime(num): count+=1
-        return num
+        if n<6: return (2,3,5,7,11)[n-1]
+        ln=math.log(n); lln=math.log(ln)
+        if n*(ln+lln)<=max(self.NTH_TABLE_MAX,self.table.limit): return self.table.nth(n)
+        # Cipolla: p_n ≈ n(ln n + ln ln n - 1 + (ln ln n - 2)/ln n); corrige com pi(x) e um crivo curto
+        x=int(n*(ln+lln-1+(lln-2)/ln)); c=self.prime_pi(x); w=max(1<<16,int(abs(n-c)*math.log(x)*1.2))
+        while c<n:
+            ps=self.table.sieve_range(x+1,x+w)
+            if c+len(ps)>=n: return int(ps[n-c-1])
+            c+=len(ps); x+=w
+        while True:
+            ps=self.table.sieve_range(x-w+1,x)
+            if c-len(ps)<n: return int(ps[n-(c-len(ps))-1])
+            c-=len(ps); x-=w
 
-    def compute(self, op:str, n:int, limit:int=1000) -> Dict:
+    def compute(self, op:str, n:int, limit:int=1000, rounds:int=0, budget_ms:int=5000) -> Dict:
         t0=time.perf_counter()
-        ops={"is_prime": lambda:{"n":n,"is_prime":self.is_prime(n)},
-             "sieve":    lambda:{"limit":limit,"primes":self.sieve(min(limit,100000)),"count":len(self.sieve(min(limit,100000)))},
-             "factorize":lambda:self.factorize(n),
+        ops={"is_prime": lambda:{"n":n,**(self.primality(n,rounds) if n>=2 else {"is_prime":False})},
+             "sieve":    lambda:{"limit":limit,"primes":self.sieve(min(limit,self.SIEVE_LIST_MAX)),
+                                 "count":self.prime_pi(limit),"table":self.table.info()},
+             "factorize":lambda:self.factorize(n,budget_ms),
              "goldbach": lambda:self.goldbach(n),
-             "nth_prime":lambda:{"n":n,"prime":self.nth_prime(min(n,10000))}}
+             "nth_prime":lambda:{"n":n,"prime":self.nth_prime(n)},
+             "pi":       lambda:{"x":n,"pi":self.prime_pi(n)}}
         fn=ops.get(op)
         if not fn: return {"error":f"Operação inválida. Use: {list(ops)}"}
-        result=fn()
+        try: result=fn()
+        except ValueError as e: return {"error":str(e)}
+        result["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
+        return result
+
+
+# ══════════════════════════════════════════════════════════════════════════════
+#  6b. NUMBER THEORY ENGINE — aritmética modular
+# ══════════════════════════════════════════════════════════════════════════════
+class NumberTheoryEngine:
+    """modpow, modinv, CRT e logaritmo discreto. As operações escalares aceitam
+    inteiros de qualquer tamanho (gmpy2 se instalado); os lotes rodam sobre
+    arrays uint64 em lanes, com o mulmod de quociente em long double do
+    PrimeEngine para módulos < VEC_MAX e o caminho escalar acima disso."""
+    BATCH_CHUNK=1<<16
+    BSGS_MAX=1<<40      # maior subgrupo de ordem prima resolvido por baby-step giant-step
+    BSGS_BLOCK=1<<12
+
+    def __init__(self, pool:Optional['WorkerPool']=None, primes:Optional['PrimeEngine']=None):
+        self.pr=primes or PrimeEngine(pool); self.pool=self.pr.pool
+
+    # ── Escalar ──────────────────────────────────────────────────────────────
+    @staticmethod
+    def modinv(a:int, m:int) -> int:
+        if m<1: raise ValueError("m deve ser >= 1")
+        g=math.gcd(a,m)
+        if g!=1: raise ValueError(f"{a} não é invertível módulo {m} (mdc = {g})")
+        return int(gmpy2.invert(a,m)) if gmpy2 is not None else pow(a,-1,m)
+
+    def modpow(self, a:int, e:int, m:int) -> int:
+        if m<1: raise ValueError("m deve ser >= 1")
+        if e<0: a,e=self.modinv(a,m),-e
+        return int(gmpy2.powmod(a,e,m)) if gmpy2 is not None else pow(a,e,m)
+
+    def crt(self, residues:List[int], moduli:List[int]) -> Optional[Tuple[int,int]]:
+        """x ≡ r_i (mod m_i) para todo i. Módulos não precisam ser coprimos;
+        devolve (x, mmc) com 0 <= x < mmc, ou None se o sistema for inconsistente."""
+        if len(residues)!=len(moduli) or not moduli: raise ValueError("residues e moduli devem ter o mesmo tamanho (>= 1)")
+        if min(moduli)<1: raise ValueError("Módulos devem ser >= 1")
+        x,M=0,1
+        for r,m in zip(residues,moduli):
+            g=math.gcd(M,m)
+            if (r-x)%g: return None
+            t=(r-x)//g*self.modinv(M//g%(m//g),m//g)%(m//g) if m//g>1 else 0
+            x+=M*t; M=M//g*m; x%=M
+        return x,M
+
+    def _order(self, g:int, m:int) -> Tuple[int,Dict[int,int]]:
+        """Ordem de g no grupo das unidades mod m e sua fatoração, via φ(m)
+        fatorado com o PrimeEngine (tabela de primos + rho/ECM)."""
+        fm=self.pr.factorize(m)
+        if not fm.get("complete",True): raise ValueError("Não foi possível fatorar m dentro do prazo")
+        phi=Counter()
+        for p,k in Counter(fm["factors"]).items():
+            if k>1: phi[p]+=k-1
+            if p>2:
+                f=self.pr.factorize(p-1)
+                if not f.get("complete",True): raise ValueError(f"Não foi possível fatorar {p}-1 dentro do prazo")
+                phi.update(f["factors"])
+        n=math.prod(p**k for p,k in phi.items())
+        for p in list(phi):
+            while phi[p] and pow(g,n//p,m)==1: n//=p; phi[p]-=1
+        return n,{p:k for p,k in phi.items() if k}
+
+    def _bsgs(self, g:int, h:int, m:int, n:int) -> Optional[int]:
+        """d em [0, n) com g^d ≡ h (mod m), sendo n a ordem de g. Passos bebê
+        e gigante são gerados em blocos vetorizados (potências de um bloco
+        vezes a potência do início de cada linha)."""
+        if n>self.BSGS_MAX: raise ValueError(f"Subgrupo de ordem prima {n} > {self.BSGS_MAX}: fora do alcance do BSGS")
+        M=math.isqrt(n-1)+1
+        if m>=self.pr.VEC_MAX or M<=self.BSGS_BLOCK:
+            baby={}; x=1
+            for j in range(M): baby.setdefault(x,j); x=x*g%m
+            c=pow(g,-M,m); y=h
+            for i in range(M):
+                if y in baby: return i*M+baby[y]
+                y=y*c%m
+            return None
+        mm=self.pr._mulmod; S=self.BSGS_BLOCK; U=np.uint64
+        def powers(b,start,k):            # start·b^j para j < k
+            row=np.empty(S,dtype=np.uint64); x=1
+            for j in range(S): row[j]=x; x=x*b%m
+            heads=np.empty(-(-k//S),dtype=np.uint64); x=start; bs=pow(b,S,m)
+            for i in range(len(heads)): heads[i]=x; x=x*bs%m
+            a=np.broadcast_to(heads[:,None],(len(heads),S)).ravel(); r=np.broadcast_to(row,(len(heads),S)).ravel()
+            return mm(a,r,np.full(len(a),m,dtype=np.uint64))[:k]
+        baby=powers(g,1,M); o=np.argsort(baby,kind="stable"); sb=baby[o]
+        giant=powers(pow(g,-M,m),h,M)
+        k=np.minimum(np.searchsorted(sb,giant),M-1); hit=np.nonzero(sb[k]==giant)[0]
+        if not len(hit): return None
+        i=int(hit[0]); return i*M+int(o[k[i]])
+
+    def dlog(self, g:int, h:int, m:int) -> Optional[Dict]:
+        """Menor x >= 0 com g^x ≡ h (mod m): ordem de g pela fatoração de φ(m),
+        Pohlig-Hellman por potência de primo (em paralelo no pool), BSGS em
+        cada subgrupo de ordem prima e CRT no fim. None se h ∉ <g>."""
+        if m<1: raise ValueError("m deve ser >= 1")
+        g%=m; h%=m
+        if m==1: return {"x":0,"order":1}
+        if math.gcd(g,m)!=1: raise ValueError("g deve ser invertível módulo m")
+        n,fac=self._order(g,m)
+        def solve(pk):
+            p,k=pk; q=p**k; gq=pow(g,n//q,m); hq=pow(h,n//q,m)
+            gam=pow(gq,p**(k-1),m); gi=pow(gq,-1,m); x=0
+            for i in range(k):
+                d=self._bsgs(gam,pow(hq*pow(gi,x,m),p**(k-1-i),m),m,p)
+                if d is None: return None
+                x+=d*p**i
+            return x,q
+        parts=self.pool.map(solve,list(fac.items())) if len(fac)>1 else list(map(solve,fac.items()))
+        if any(r is None for r in parts): return None
+        x=self.crt([r for r,_ in parts],[q for _,q in parts])[0] if parts else 0
+        return {"x":x,"order":n} if pow(g,x,m)==h else None
+
+    # ── Lote (uint64) ────────────────────────────────────────────────────────
+    def _chunks(self, fn, n:int, workers:int) -> List:
+        return self.pool.map(fn,range(0,n,self.BATCH_CHUNK),workers=workers)
+
+    def modpow_batch(self, b:np.ndarray, e:np.ndarray, m:np.ndarray, workers:int=0) -> np.ndarray:
+        """b^e mod m por lane (arrays uint64 com broadcast)."""
+        b,e,m=(np.ascontiguousarray(x,dtype=np.uint64) for x in np.broadcast_arrays(b,e,m))
+        if len(m) and not m.all(): raise ValueError("Módulo 0 no lote")
+        def run(i):
+            s=slice(i,i+self.BATCH_CHUNK); bb,ee,mm=b[s],e[s],m[s]
+            out=np.zeros(len(mm),dtype=np.uint64); vec=mm<self.pr.VEC_MAX
+            if vec.any(): out[vec]=self.pr._powmod_vec(bb[vec],ee[vec],mm[vec])%mm[vec]
+            for j in np.nonzero(~vec)[0]: out[j]=pow(int(bb[j]),int(ee[j]),int(mm[j]))
+            return out
+        return np.concatenate([np.zeros(0,dtype=np.uint64)]+self._chunks(run,len(m),workers))
+
+    def modinv_batch(self, a:np.ndarray, m:np.ndarray, workers:int=0) -> Tuple[np.ndarray,np.ndarray]:
+        """Inverso de a mod m por lane, por Euclides estendido em lanes (os
+        coeficientes ficam reduzidos mod m). Devolve (inversos, invertível);
+        lanes sem inverso saem com 0."""
+        a,m=(np.ascontiguousarray(x,dtype=np.uint64) for x in np.broadcast_arrays(a,m))
+        if len(m) and not m.all(): raise ValueError("Módulo 0 no lote")
+        mm=self.pr._mulmod
+        def run(i):
+            s=slice(i,i+self.BATCH_CHUNK); n=m[s]
+            out=np.zeros(len(n),dtype=np.uint64); ok=np.zeros(len(n),dtype=bool)
+            vec=np.nonzero(n<self.pr.VEC_MAX)[0]
+            nv=n[vec]; r0=nv.copy(); r1=a[s][vec]%nv; t0=np.zeros_like(nv); t1=np.ones_like(nv)%nv
+            act=np.nonzero(r1)[0]
+            while len(act):
+                N=nv[act]; q=r0[act]//r1[act]
+                r0[act],r1[act]=r1[act],r0[act]-q*r1[act]
+                t0[act],t1[act]=t1[act],(t0[act]+N-mm(q%N,t1[act],N))%N
+                act=act[r1[act]!=0]
+            ok[vec]=r0==1; out[vec]=np.where(r0==1,t0,0)
+            for j in np.nonzero(n>=self.pr.VEC_MAX)[0]:
+                x,y=int(a[s][j]),int(n[j])
+                if math.gcd(x,y)==1: out[j]=pow(x,-1,y); ok[j]=True
+            return out,ok
+        parts=self._chunks(run,len(m),workers)
+        return (np.concatenate([np.zeros(0,dtype=np.uint64)]+[p[0] for p in parts]),
+                np.concatenate([np.zeros(0,dtype=bool)]+[p[1] for p in parts]))
+
+    def crt_batch(self, R:np.ndarray, moduli:List[int], workers:int=0) -> np.ndarray:
+        """Reconstrói uma linha de R (N×k resíduos) por vez contra os mesmos k
+        módulos coprimos, por Garner em lanes: as constantes são calculadas uma
+        vez e cada passo é um mulmod vetorizado. O produto precisa caber em VEC_MAX."""
+        R=np.asarray(R,dtype=np.uint64); k=len(moduli)
+        if R.ndim!=2 or R.shape[1]!=k or not k: raise ValueError("Resíduos devem vir em linhas de len(moduli)")
+        if min(moduli)<1: raise ValueError("Módulos devem ser >= 1")
+        if any(math.gcd(moduli[i],moduli[j])!=1 for i in range(k) for j in range(i)): raise ValueError("Módulos do lote devem ser coprimos dois a dois")
+        if math.prod(moduli)>=self.pr.VEC_MAX: raise ValueError(f"Produto dos módulos deve ser < {self.pr.VEC_MAX}")
+        pre=[]; M=1
+        for q in moduli: pre.append((np.uint64(q),np.uint64(M),np.uint64(pow(M,-1,q) if q>1 else 0))); M*=q
+        mm=self.pr._mulmod
+        def run(i):
+            X=R[i:i+self.BATCH_CHUNK]; x=np.zeros(len(X),dtype=np.uint64)
+            for j,(q,Mj,c) in enumerate(pre):
+                Q=np.full(len(X),q,dtype=np.uint64)
+                t=mm((X[:,j]%q+q-x%q)%q,np.full(len(X),c,dtype=np.uint64),Q)
+                x=x+Mj*t
+            return x
+        return np.concatenate([np.zeros(0,dtype=np.uint64)]+self._chunks(run,len(R),workers))
+
+    def compute(self, op:str, a:int=0, b:int=0, m:int=1, residues:Optional[List[int]]=None,
+                moduli:Optional[List[int]]=None) -> Dict:
+        t0=time.perf_counter()
+        def crt():
+            r=self.crt(residues or [],moduli or [])
+            return {"x":r[0],"modulus":r[1]} if r else {"x":None,"solvable":False}
+        ops={"modpow":lambda:{"result":self.modpow(a,b,m)},
+             "modinv":lambda:{"result":self.modinv(a%m,m)},
+             "crt":   crt,
+             "dlog":  lambda:self.dlog(a,b,m) or {"x":None,"solvable":False}}
+        fn=ops.get(op)
+        if not fn: return {"error":f"Operação inválida. Use: {list(ops)}"}
+        try: result={"operation":op,**fn()}
+        except ValueError as e: return {"error":str(e)}
         result["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
         return result
 
@@ -461,20 +2215,189 @@ class PrimeEngine:
 #  7. SEQUENCE ENGINE (Fibonacci, Collatz, etc.)
 # ══════════════════════════════════════════════════════════════════════════════
 class SequenceEngine:
-    def fibonacci(self,n:int)->Dict:
-        if n>10000: n=10000
-        seq=[0,1]
-        for i in range(2,n): seq.append(seq[-1]+seq[-2])
-        return {"n":n,"sequence":seq[:min(50,n)],"last":seq[n-1],"golden_ratio":round(seq[-1]/seq[-2],10) if n>1 else None}
+    FIB_MAX=2*10**7     # sem mod: F(2e7) tem ~4,2M dígitos (~10 s com int do CPython, bem menos com gmpy2)
+    LIST_MAX=50         # termos iniciais listados
+    INT_DIGITS=4000     # acima disso o valor vai como string (limite de int→str do CPython é 4300)
+
+    def __init__(self, pool:Optional['WorkerPool']=None):
+        self.pool=pool; self._lock=threading.Lock(); self._memo_st=None
+
+    @staticmethod
+    def _fib_pair(n:int, m:int=0) -> Tuple[int,int]:
+        """(F(n), F(n+1)) por duplicação: F(2k) = F(k)(2F(k+1) - F(k)),
+        F(2k+1) = F(k)² + F(k+1)²; O(log n) multiplicações, reduzidas mod m se m."""
+        if gmpy2 is not None and not m:
+            a,b=gmpy2.fib2(n+1); return int(b),int(a)
+        a,b=0,1
+        for bit in bin(n)[2:]:
+            c=a*(2*b-a); d=a*a+b*b
+            if m: c%=m; d%=m
+            a,b=(d,c+d) if bit=="1" else (c,d)
+        return (a%m,b%m) if m else (a,b)
+
+    @staticmethod
+    def _to_str(x:int, fmt:str="dec") -> str:
+        """Inteiro grande em texto sem o limite de 4300 dígitos: hex é linear;
+        decimal divide x em metades binárias e remonta em Decimal, cuja
+        multiplicação (libmpdec) é sub-quadrática — o int→str do CPython é quadrático."""
+        if fmt=="hex": return hex(x)
+        if gmpy2 is not None: return gmpy2.mpz(x).digits(10)
+        if x.bit_length()<=4096: return str(x)
+        D=decimal; ctx=D.Context(prec=D.MAX_PREC,Emax=D.MAX_EMAX,Emin=D.MIN_EMIN); p2={}
+        def half(v,w):
+            if w<=4096: return D.Decimal(v)
+            w2=w>>1; hi=v>>w2
+            if w2 not in p2: p2[w2]=ctx.power(D.Decimal(2),w2)
+            return ctx.add(half(v-(hi<<w2),w2),ctx.multiply(half(hi,w-w2),p2[w2]))
+        s=str(half(abs(x),x.bit_length()))
+        return "-"+s if x<0 else s
+
+    def _value(self, x:int, fmt:str) -> Dict:
+        s=self._to_str(x,fmt)
+        if fmt=="dec" and len(s)<=self.INT_DIGITS: return {"last":x,"digits":len(s.lstrip("-"))}
+        return {"last":s,**({"digits":len(s.lstrip("-"))} if fmt=="dec" else {"bits":x.bit_length()})}
+
+    def _head(self, a:int, b:int, n:int, m:int) -> List[int]:
+        out=[]
+        for _ in range(min(self.LIST_MAX,n)):
+            out.append(a%m if m else a); a,b=b,a+b
+        return out
+
+    def _check(self, n:int, mod:Optional[int]):
+        if mod is None and n>self.FIB_MAX: raise ValueError(f"Sem mod, n deve ser <= {self.FIB_MAX}")
+        if mod is not None and mod<1: raise ValueError("mod deve ser >= 1")
+
+    def fibonacci(self,n:int,mod:Optional[int]=None,fmt:str="dec")->Dict:
+        """Termos F(0)..F(n-1): os LIST_MAX primeiros e o último, F(n-1)."""
+        self._check(n,mod); m=mod or 0
+        a,b=self._fib_pair(n-1,m)
+        r={"n":n,"sequence":self._head(0,1,n,m),**self._value(a,fmt)}
+        if mod is not None: r["mod"]=mod
+        elif n>1: r["golden_ratio"]=round(a/(b-a),10) if b>a else None   # F(n-1)/F(n-2)
+        return r
 
     def collatz(self,n:int)->Dict:
+        """Trajetória de um início: só os 100 primeiros termos são guardados."""
         if n<1: return {"error":"n deve ser >= 1"}
-        seq=[n]; steps=0
+        start=n; seq=[n]; steps=0; peak=n
         while n!=1:
-            n=n//2 if n%2==0 else 3*n+1
-            seq.append(n); steps+=1
-            if steps>100000: break
-        return {"start":seq[0],"steps":steps,"max_value":max(seq),"sequence":seq[:100]}
+            n=n>>1 if n%2==0 else 3*n+1
+            if n>peak: peak=n
+            if len(seq)<100: seq.append(n)
+            steps+=1
+        return {"start":start,"steps":steps,"max_value":peak,"sequence":seq}
+
+    # ── Collatz em faixas ────────────────────────────────────────────────────
+    # Cada início é uma lane uint64. Abaixo de 2^MEMO_BITS o resto da trajetória
+    # (passos, pico) vem da memo; acima, um salto de JUMP_BITS passos T de uma
+    # vez: n = 2^K·h + l ⇒ T^K(n) = 3^c[l]·h + d[l]. O salto só é dado quando a
+    # cota dos valores intermediários (U[l]·n + V[l]) não passa do pico da lane,
+    # então o pico continua exato; senão a lane anda um passo. Lanes em que
+    # 3n+1 estouraria 64 bits terminam no escalar com int do Python.
+    MEMO_BITS=20
+    JUMP_BITS=12
+    COLLATZ_CHUNK=1<<16
+    COLLATZ_SPAN_MAX=2*10**7
+    COLLATZ_BYTES=40        # pico por início (~32 medidos: blocos, concatenação, recordes, percentis)
+    COLLATZ_MAX=1<<62
+    RECORDS_MAX=1000
+
+    def _collatz_tables(self):
+        K=self.JUMP_BITS; l=np.arange(1<<K,dtype=np.int64)
+        A=np.full(len(l),1<<K,dtype=np.int64); B=l.copy(); c=np.zeros(len(l),dtype=np.int64)
+        U=np.ones(len(l)); V=np.zeros(len(l))
+        for _ in range(K):
+            s=A/(1<<K); t=B-s*l; odd=B&1==1
+            U=np.maximum(U,np.where(odd,3*s,s)); V=np.maximum(V,np.where(odd,3*t+1,t))   # 3x+1 antes de dividir
+            A=np.where(odd,3*A,A)>>1; B=np.where(odd,3*B+1,B)>>1; c+=odd
+            s=A/(1<<K); U=np.maximum(U,s); V=np.maximum(V,B-s*l)
+        return A.astype(np.uint64),B.astype(np.uint64),(K+c).astype(np.int64),U*(1+2**-30),V+1
+
+    def _collatz_scalar(self, n:int, steps:int, peak:int, below:int) -> Tuple[int,int]:
+        while n>=below:
+            if n&1: n=3*n+1; peak=max(peak,n); n>>=1; steps+=2
+            else: n>>=1; steps+=1
+        ms,mp=self._memo
+        return steps+int(ms[n]),max(peak,int(mp[n]))
+
+    def _collatz_lanes(self, n0:np.ndarray, below:int, ms:np.ndarray, mp:np.ndarray) -> Tuple[np.ndarray,np.ndarray,Dict]:
+        """(passos até 1, pico) por início; valores < below saem da memo."""
+        P3,D,SK,U,V=self._jump; K=self.JUMP_BITS; mask=np.uint64((1<<K)-1)
+        LIM=np.uint64((2**64-2)//3); one=np.uint64(1)
+        n=n0.astype(np.uint64); idx=np.arange(len(n)); st=np.zeros(len(n),dtype=np.int64); pk=n.copy()
+        out_s=np.zeros(len(n),dtype=np.int64); out_p=np.zeros(len(n),dtype=np.uint64); over={}
+        while len(idx):
+            fin=n<below
+            if fin.any():
+                v=n[fin].astype(np.intp); out_s[idx[fin]]=st[fin]+ms[v]; out_p[idx[fin]]=np.maximum(pk[fin],mp[v])
+                k=~fin; n,idx,st,pk=n[k],idx[k],st[k],pk[k]
+                if not len(idx): break
+            l=(n&mask).astype(np.intp)
+            safe=(n>=np.uint64(1<<K))&(n.astype(np.float64)*U[l]+V[l]<=pk.astype(np.float64)*(1-2**-30))
+            j=np.nonzero(safe)[0]
+            if len(j): n[j]=P3[l[j]]*(n[j]>>np.uint64(K))+D[l[j]]; st[j]+=SK[l[j]]
+            u=np.nonzero(~safe)[0]
+            if len(u):
+                o=u[n[u]&one==one]; e=u[n[u]&one==0]
+                big=o[n[o]>LIM]; o=o[n[o]<=LIM]
+                m=np.uint64(3)*n[o]+one; pk[o]=np.maximum(pk[o],m); n[o]=m>>one; st[o]+=2
+                n[e]>>=one; st[e]+=1
+                if len(big):                        # 3n+1 não cabe em 64 bits
+                    for i in big:
+                        s,p=self._collatz_scalar(int(n[i]),int(st[i]),int(pk[i]),below)
+                        over[int(idx[i])]=p; out_s[idx[i]]=s; out_p[idx[i]]=np.uint64(2**64-1)
+                    k=np.ones(len(n),dtype=bool); k[big]=False; n,idx,st,pk=n[k],idx[k],st[k],pk[k]
+        return out_s,out_p,over
+
+    @property
+    def _memo(self) -> Tuple[np.ndarray,np.ndarray]:
+        """(passos, pico) de todo n < 2^MEMO_BITS, montada uma vez em faixas
+        [lo, 2lo): cada faixa só consulta valores já resolvidos (< lo)."""
+        if self._memo_st is None:
+            with self._lock:
+                if self._memo_st is None:
+                    self._jump=self._collatz_tables(); M=1<<self.MEMO_BITS
+                    ms=np.zeros(M,dtype=np.int64); mp=np.zeros(M,dtype=np.uint64); mp[1]=1
+                    lo=2
+                    while lo<M:
+                        s,p,_=self._collatz_lanes(np.arange(lo,2*lo,dtype=np.uint64),lo,ms,mp)
+                        ms[lo:2*lo]=s; mp[lo:2*lo]=p; lo*=2
+                    self._memo_st=(ms,mp)
+        return self._memo_st
+
+    def collatz_range(self, a:int, b:int, workers:int=0) -> Dict:
+        """Estatísticas de tempo total de parada (passos até 1) e excursão
+        máxima sobre os inícios [a, b], com os recordistas dentro da faixa.
+        Blocos de inícios rodam em paralelo no pool; a agregação segue a ordem."""
+        if a<1 or b<a: raise ValueError("Use 1 <= a <= b")
+        if b>=self.COLLATZ_MAX: raise ValueError(f"b deve ser < {self.COLLATZ_MAX}")
+        if b-a+1>self.COLLATZ_SPAN_MAX: raise ValueError(f"Faixa máxima: {self.COLLATZ_SPAN_MAX} inícios")
+        t0=time.perf_counter(); ms,mp=self._memo; M=1<<self.MEMO_BITS
+        def run(lo):
+            hi=min(b,lo+self.COLLATZ_CHUNK-1)
+            return self._collatz_lanes(np.arange(lo,hi+1,dtype=np.uint64),M,ms,mp)
+        starts=range(a,b+1,self.COLLATZ_CHUNK)
+        W=max(1,min(workers or (self.pool.threads if self.pool else 1),self.pool.threads if self.pool else 1))
+        parts=self.pool.map(run,starts,workers=W) if self.pool and W>1 else list(map(run,starts))
+        steps=np.concatenate([p[0] for p in parts])
+        over={i*self.COLLATZ_CHUNK+k:v for i,p in enumerate(parts) for k,v in p[2].items()}
+        peak=np.concatenate([p[1] for p in parts]); del parts
+        if over:                                    # picos além de 64 bits: inteiros do Python
+            peak=peak.astype(object)
+            for k,v in over.items(): peak[k]=v
+        def records(x):
+            rm=np.maximum.accumulate(x); r=np.nonzero(np.concatenate(([True],x[1:]>rm[:-1])))[0]
+            return len(r),[[a+int(i),int(x[i])] for i in r[:self.RECORDS_MAX]]
+        ns,rs=records(steps); npk,rp=records(peak)
+        i,j=int(steps.argmax()),int(np.argmax(peak))
+        dt=time.perf_counter()-t0
+        return {"a":a,"b":b,"count":len(steps),
+                "steps":{"total":int(steps.sum()),"mean":round(float(steps.mean()),4),"min":int(steps.min()),
+                         "max":int(steps[i]),"argmax":a+i,"p50":float(np.percentile(steps,50)),"p99":float(np.percentile(steps,99))},
+                "peak":{"max":int(peak[j]),"argmax":a+j},
+                "records":{"steps":rs,"steps_count":ns,"peak":rp,"peak_count":npk},
+                "overflow_lanes":len(over),"chunks":len(starts),"workers":W,"seconds":round(dt,6),
+                "starts_per_sec":round(len(steps)/dt,2) if dt else None}
 
     def pascal(self,rows:int)->Dict:
         rows=min(rows,20)
@@ -485,49 +2408,544 @@ class SequenceEngine:
             row.append(1); triangle.append(row)
         return {"rows":rows,"triangle":triangle}
 
-    def lucas(self,n:int)->Dict:
-        n=min(n,10000)
-        seq=[2,1]
-        for i in range(2,n): seq.append(seq[-1]+seq[-2])
-        return {"n":n,"sequence":seq[:min(50,n)],"last":seq[n-1]}
+    def lucas(self,n:int,mod:Optional[int]=None,fmt:str="dec")->Dict:
+        """Termos L(0)..L(n-1), com L(k) = 2F(k+1) - F(k)."""
+        self._check(n,mod); m=mod or 0
+        f,g=self._fib_pair(n-1,m); v=2*g-f
+        r={"n":n,"sequence":self._head(2,1,n,m),**self._value(v%m if m else v,fmt)}
+        if mod is not None: r["mod"]=mod
+        return r
+
+    def tribonacci(self,n:int,mod:Optional[int]=None,fmt:str="dec")->Dict:
+        c,i=self.PRESETS["tribonacci"]
+        r={"n":n,"sequence":self.recurrence_range(c,i,0,min(self.LIST_MAX,n)-1,mod),
+           **self._value(self.recurrence_nth(c,i,n-1,mod),fmt)}
+        if mod is not None: r["mod"]=mod
+        return r
+
+    # ── Recorrências lineares ────────────────────────────────────────────────
+    # a(n) = c1·a(n-1) + … + ck·a(n-k). Kitamasa: a(n) = Σ r_j·a(j), com
+    # r(x) = x^n mod P(x), P(x) = x^k - c1·x^(k-1) - … - ck. Os produtos de
+    # polinômios usam substituição de Kronecker (um único produto de inteiros
+    # grandes, Karatsuba no CPython) e a redução mod P é a de Barrett, com a
+    # série inversa de rev(P) calculada uma vez: O(M(k)·log n).
+    PRESETS={"fibonacci":([1,1],[0,1]),"lucas":([1,1],[2,1]),"tribonacci":([1,1,1],[0,0,1]),
+             "pell":([2,1],[0,1]),"jacobsthal":([1,2],[0,1]),"padovan":([0,1,1],[1,1,1]),
+             "perrin":([0,1,1],[3,0,2])}
+    REC_K_MAX=2000          # ordem máxima
+    REC_EXACT_WORK=4*10**7  # sem mod: n·k·(bits de coeffs + bits de init) máximo (~bits do termo · k)
+    REC_RANGE_WORK=5*10**6  # faixas: nº de termos · k
+    BM_MAX=5000             # termos aceitos pelo Berlekamp-Massey em Z/p (O(N²))
+    BM_RAT_MAX=1000         # sobre os racionais: termos aceitos
+    BM_RAT_WORK=3*10**7     # e Σ L·bits dos coeficientes de C (as frações crescem a cada passo)
+
+    @staticmethod
+    def _pmul(a:List[int], b:List[int]) -> List[int]:
+        """Produto de polinômios de coeficientes inteiros (com sinal) via
+        Kronecker: empacota em fatias de W bits, multiplica, desempacota."""
+        if not a or not b: return []
+        if min(len(a),len(b))<=8:
+            out=[0]*(len(a)+len(b)-1)
+            for i,x in enumerate(a):
+                if x:
+                    for j,y in enumerate(b): out[i+j]+=x*y
+            return out
+        w=max(map(abs,a)).bit_length()+max(map(abs,b)).bit_length()+min(len(a),len(b)).bit_length()+2
+        Wb=-(-w//8); h=1<<(8*Wb-1)
+        def pack(v):
+            pos=b"".join(max(x,0).to_bytes(Wb,"little") for x in v)
+            neg=b"".join(max(-x,0).to_bytes(Wb,"little") for x in v)
+            return int.from_bytes(pos,"little")-int.from_bytes(neg,"little")
+        L=len(a)+len(b)-1
+        X=pack(a)*pack(b)+int.from_bytes(h.to_bytes(Wb,"little")*L,"little")
+        buf=X.to_bytes(Wb*L,"little")
+        return [int.from_bytes(buf[i:i+Wb],"little")-h for i in range(0,Wb*L,Wb)]
+
+    def _rec_check(self, coeffs:List[int], init:List[int], mod:Optional[int]):
+        k=len(coeffs)
+        if not k or len(init)!=k: raise ValueError("coeffs e init devem ter o mesmo tamanho (>= 1)")
+        if k>self.REC_K_MAX: raise ValueError(f"Ordem máxima: {self.REC_K_MAX}")
+        if mod is not None and mod<1: raise ValueError("mod deve ser >= 1")
+
+    def _exact_work(self, coeffs:List[int], init:List[int], n:int) -> int:
+        """Custo de a(n) sem mod: o termo tem ~n·(bits de coeffs + bits de init) bits."""
+        cb=max(1,max(abs(c) for c in coeffs).bit_length()); ib=max(1,max(abs(x) for x in init).bit_length())
+        return n*len(coeffs)*(cb+ib)
+
+    def _xpow(self, coeffs:List[int], n:int, m:int) -> List[int]:
+        """x^n mod P(x) (coeficientes de x^0..x^(k-1)), reduzidos mod m se m."""
+        k=len(coeffs); red=(lambda v:[x%m for x in v]) if m else (lambda v:v)
+        C=red([coeffs[k-1-j] for j in range(k)])       # P = x^k - C(x)
+        Q=[1]+[0]*(k-2)                                 # 1/rev(P) mod x^(k-1): a própria recorrência
+        for j in range(1,k-1):
+            Q[j]=sum(coeffs[i-1]*Q[j-i] for i in range(1,min(j,k)+1))
+            if m: Q[j]%=m
+        def mulmod(a,b):
+            A=self._pmul(a,b); A+=[0]*(2*k-1-len(A))
+            if k==1: return red(A)
+            q=self._pmul(red(A[:k-1:-1]),Q)[:k-1][::-1]    # quociente de A por P
+            return red([x+y for x,y in zip(A[:k],self._pmul(red(q),C)+[0]*k)])
+        def mulx(r):                                       # x·r, com x^k ≡ C(x)
+            t=r[-1]; return red([x+t*c for x,c in zip([0]+r[:-1],C)])
+        r=[1]+[0]*(k-1)
+        if not n: return red(r)
+        r=mulx(r)
+        for bit in bin(n)[3:]:
+            r=mulmod(r,r)
+            if bit=="1": r=mulx(r)
+        return r
+
+    def recurrence_nth(self, coeffs:List[int], init:List[int], n:int, mod:Optional[int]=None) -> int:
+        self._rec_check(coeffs,init,mod); k=len(coeffs); m=mod or 0
+        if mod is None and self._exact_work(coeffs,init,n)>self.REC_EXACT_WORK:
+            raise ValueError(f"Sem mod, n·k·(bits de coeffs + bits de init) deve ser <= {self.REC_EXACT_WORK}")
+        if n<k: return init[n]%m if m else init[n]
+        r=self._xpow(coeffs,n,m); v=sum(x*y for x,y in zip(r,init))
+        return v%m if m else v
 
-    def tribonacci(self,n:int)->Dict:
-        n=min(n,5000)
-        seq=[0,0,1]
-        for i in range(3,n): seq.append(seq[-1]+seq[-2]+seq[-3])
-        return {"n":n,"sequence":seq[:min(50,n)],"last":seq[n-1]}
+    def recurrence_range(self, coeffs:List[int], init:List[int], lo:int, hi:int, mod:Optional[int]=None) -> List[int]:
+        """a(lo)..a(hi): a janela inicial sai de x^lo mod P (Kitamasa), o resto
+        pela própria recorrência."""
+        self._rec_check(coeffs,init,mod); k=len(coeffs); m=mod or 0
+        if (hi-lo+1)*k>self.REC_RANGE_WORK: raise ValueError(f"Faixa: nº de termos · k deve ser <= {self.REC_RANGE_WORK}")
+        if mod is None and self._exact_work(coeffs,init,hi)>self.REC_EXACT_WORK:
+            raise ValueError(f"Sem mod, hi·k·(bits de coeffs + bits de init) deve ser <= {self.REC_EXACT_WORK}")
+        step=lambda w:(lambda v:v%m if m else v)(sum(c*w[-i] for i,c in enumerate(coeffs,1)))
+        ext=[x%m if m else x for x in init]
+        while len(ext)<min(2*k-1,hi+1): ext.append(step(ext))
+        if lo<len(ext): out,s=ext,lo
+        else:
+            r=self._xpow(coeffs,lo,m); s=0
+            out=[(lambda v:v%m if m else v)(sum(x*y for x,y in zip(r,ext[j:j+k]))) for j in range(k)]
+        while len(out)<s+hi-lo+1: out.append(step(out[-k:]))
+        return out[s:s+hi-lo+1]
 
-    def compute(self,op:str,n:int)->Dict:
+    def berlekamp_massey(self, terms:List[int], mod:Optional[int]=None) -> List:
+        """Menor recorrência que gera terms: sobre Z/p com mod (p primo) ou
+        sobre os racionais sem mod. Devolve c1..cL. Sobre os racionais numeradores
+        e denominadores crescem a cada correção, então o limite é menor e o custo
+        acumulado (ordem · bits dos coeficientes) é conferido a cada passo."""
+        if not terms: raise ValueError("terms vazio")
+        cap=self.BM_MAX if mod is not None else self.BM_RAT_MAX
+        if len(terms)>cap: raise ValueError(f"Máximo de {cap} termos"+("" if mod is not None else " sem mod"))
+        if mod is not None:
+            if mod<2: raise ValueError("mod deve ser primo")
+            inv=lambda x:pow(x,-1,mod); s=[t%mod for t in terms]; red=lambda x:x%mod
+        else:
+            inv=lambda x:1/Fraction(x); s=[Fraction(t) for t in terms]; red=lambda x:x
+        C=[red(1)]; B=[red(1)]; L=0; sh=1; b=red(1); work=0
+        for n in range(len(s)):
+            if mod is None and L:
+                work+=L*max(x.numerator.bit_length()+x.denominator.bit_length() for x in C)
+                if work>self.BM_RAT_WORK:
+                    raise ValueError(f"Berlekamp-Massey sem mod passou do limite de custo (ordem {L} em {n} termos); informe mod primo")
+            d=red(s[n]+sum(C[i]*s[n-i] for i in range(1,L+1)))
+            if not d: sh+=1; continue
+            try: f=red(d*inv(b))
+            except ValueError: raise ValueError("mod deve ser primo para o Berlekamp-Massey")
+            T=C[:]; C=C+[red(0)]*(len(B)+sh-len(C))
+            for i,x in enumerate(B): C[i+sh]=red(C[i+sh]-f*x)
+            if 2*L<=n: L,B,b,sh=n+1-L,T,d,1
+            else: sh+=1
+        C+=[red(0)]*(L+1-len(C)); c=[red(-C[i]) for i in range(1,L+1)]
+        if mod is not None and any(red(sum(x*s[n-i] for i,x in enumerate(c,1))-s[n]) for n in range(L,len(s))):
+            raise ValueError("mod deve ser primo para o Berlekamp-Massey")   # Z/m sem corpo: resultado inválido
+        return c
+
+    def recurrence(self, coeffs:Optional[List[int]]=None, init:Optional[List[int]]=None, preset:Optional[str]=None,
+                   n:Optional[int]=None, lo:Optional[int]=None, hi:Optional[int]=None,
+                   mod:Optional[int]=None, fmt:str="dec") -> Dict:
+        t0=time.perf_counter()
+        try:
+            if preset:
+                if preset not in self.PRESETS: return {"error":f"Preset inválido. Use: {list(self.PRESETS)}"}
+                coeffs,init=self.PRESETS[preset]
+            if not coeffs or init is None: return {"error":"Informe preset ou coeffs + init"}
+            r={"preset":preset,"coeffs":coeffs,"init":init,"k":len(coeffs)}
+            if mod is not None: r["mod"]=mod
+            if n is not None:
+                v=self.recurrence_nth(coeffs,init,n,mod); r["n"]=n
+                r.update({("term" if k=="last" else k):x for k,x in self._value(v,fmt).items()})
+            if lo is not None:
+                if hi is None or hi<lo: return {"error":"hi deve ser >= lo"}
+                r.update(lo=lo,hi=hi,terms=[x if abs(x).bit_length()<=13000 else self._to_str(x,fmt)
+                                            for x in self.recurrence_range(coeffs,init,lo,hi,mod)])
+            if n is None and lo is None: return {"error":"Informe n ou lo/hi"}
+        except ValueError as e: return {"error":str(e)}
+        r["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
+        return r
+
+    def infer(self, terms:List[int], mod:Optional[int]=None) -> Dict:
         t0=time.perf_counter()
-        ops={"fibonacci":self.fibonacci,"collatz":self.collatz,
-             "pascal":self.pascal,"lucas":self.lucas,"tribonacci":self.tribonacci}
+        try: c=self.berlekamp_massey(terms,mod)
+        except ValueError as e: return {"error":str(e)}
+        fmt=lambda x:x if isinstance(x,int) else (int(x) if x.denominator==1 else f"{x.numerator}/{x.denominator}")
+        L=len(c)
+        return {"order":L,"coeffs":[fmt(x) for x in c],"init":[t%mod if mod else t for t in terms[:L]],
+                "unique":2*L<=len(terms),**({"mod":mod} if mod is not None else {}),
+                "latency_us":round((time.perf_counter()-t0)*1e6,4)}
+
+    # ── Streaming por cursor ─────────────────────────────────────────────────
+    # O estado de um stream é (op, posição, estado da recorrência): a janela
+    # a(pos)..a(pos+k-1) nas recorrências, o valor corrente no Collatz. O
+    # cursor é esse estado em JSON/base64url; sem a janela (grande demais, ou
+    # cursor só de posição) a retomada refaz a janela por Kitamasa em
+    # O(M(k)·log pos). Os termos saem em blocos gerados sob demanda.
+    STREAM_MAX=10**6            # termos por chamada
+    STREAM_STATE_BITS=1<<16     # janela maior que isso não vai no cursor
+    STREAM_POS_MAX=10**18
+    STREAM_SEED_MAX=1<<1024
+
+    def stream_open(self, op:Optional[str]=None, pos:int=0, coeffs:Optional[List[int]]=None, init:Optional[List[int]]=None,
+                    mod:Optional[int]=None, seed:Optional[int]=None, cursor:Optional[str]=None) -> Dict:
+        """Estado inicial do stream, de um cursor ou dos parâmetros (op é um
+        preset, "recurrence" com coeffs + init, ou "collatz" com seed)."""
+        if cursor:
+            try:
+                st=json.loads(base64.urlsafe_b64decode(cursor+"="*(-len(cursor)%4)))
+                op,pos,mod=st["op"],st["pos"],st.get("mod"); coeffs,init,seed=st.get("coeffs"),st.get("init"),st.get("seed")
+                win=st.get("state")
+            except (ValueError,KeyError,TypeError,AttributeError): raise ValueError("cursor inválido")
+            self._cursor_check(op,pos,mod,coeffs,init,seed,win)
+        else: win=None
+        if pos<0: raise ValueError("pos deve ser >= 0")
+        if op=="collatz":
+            if seed is None or seed<1: raise ValueError("collatz: seed deve ser >= 1")
+            st={"op":op,"pos":pos,"seed":seed,"state":win}
+            if win is None:                              # sem atalho: anda pos passos
+                x=seed
+                for _ in range(pos):
+                    if x==1: x=None; break
+                    x=x>>1 if x%2==0 else 3*x+1
+                st["state"]=x
+            return st
+        if op in self.PRESETS: coeffs,init=self.PRESETS[op]
+        elif op!="recurrence": raise ValueError(f"Operação inválida. Use: {['recurrence','collatz']+list(self.PRESETS)}")
+        if not coeffs or init is None: raise ValueError("recurrence: informe coeffs + init")
+        self._rec_check(coeffs,init,mod); k=len(coeffs)
+        if win is not None and len(win)!=k: raise ValueError("cursor inválido")
+        if win is None: win=self.recurrence_range(coeffs,init,pos,pos+k-1,mod)
+        return {"op":op,"pos":pos,"mod":mod,"coeffs":coeffs,"init":init,"state":win}
+
+    def _cursor_check(self, op, pos, mod, coeffs, init, seed, win):
+        """O cursor vem do cliente: os campos passam pelos mesmos limites e
+        tipos de SequenceStreamReq (e a janela, pelos do próprio cursor)."""
+        isint=lambda x:type(x) is int
+        ints=lambda v:v is None or (type(v) is list and len(v)<=self.REC_K_MAX and all(map(isint,v)))
+        ok=(type(op) is str and isint(pos) and 0<=pos<=self.STREAM_POS_MAX
+            and (mod is None or (isint(mod) and mod>=1)) and ints(coeffs) and ints(init)
+            and (seed is None or (isint(seed) and 1<=seed<self.STREAM_SEED_MAX)))
+        if ok and win is not None:
+            if op=="collatz": ok=isint(win) and 1<=win and win.bit_length()<=self.STREAM_STATE_BITS
+            else: ok=ints(win) and sum(abs(x).bit_length() for x in win)<=self.STREAM_STATE_BITS and \
+                     (mod is None or all(0<=x<mod for x in win))
+        if not ok: raise ValueError("cursor inválido")
+
+    def stream_cursor(self, st:Dict, with_state:bool=True) -> Optional[str]:
+        """Cursor do estado corrente (None quando o Collatz chegou a 1)."""
+        if st["op"]=="collatz" and st["state"] is None: return None
+        c={k:v for k,v in st.items() if v is not None and not (k in ("coeffs","init") and st["op"]!="recurrence")}
+        if not with_state or (st["op"]!="collatz" and sum(abs(x).bit_length() for x in st["state"])>self.STREAM_STATE_BITS):
+            c.pop("state",None)
+        return base64.urlsafe_b64encode(json.dumps(c,separators=(",",":")).encode()).rstrip(b"=").decode()
+
+    def stream(self, st:Dict, count:int, chunk:int=4096):
+        """Gera (pos, termos) em blocos de até chunk termos, avançando st. O
+        gerador é preguiçoso: nada é calculado além do bloco pedido."""
+        if count<0 or count>self.STREAM_MAX: raise ValueError(f"count deve estar em [0, {self.STREAM_MAX}]")
+        if st["op"]!="collatz" and st["mod"] is None and self._exact_work(st["coeffs"],st["init"],st["pos"]+count)>self.REC_EXACT_WORK:
+            raise ValueError(f"Sem mod, (pos + count)·k·(bits de coeffs + bits de init) deve ser <= {self.REC_EXACT_WORK}")
+        chunk=max(1,chunk)
+        def gen():
+            left=count
+            if st["op"]=="collatz":
+                while left and st["state"] is not None:
+                    x=st["state"]; p0=st["pos"]; out=[]
+                    for _ in range(min(chunk,left)):
+                        out.append(x)
+                        if x==1: x=None; break
+                        x=x>>1 if x%2==0 else 3*x+1
+                    st["state"]=x; st["pos"]=p0+len(out); left-=len(out)
+                    yield p0,out
+                return
+            c=st["coeffs"]; k=len(c); m=st["mod"] or 0
+            while left:
+                n=min(chunk,left); out=list(st["state"])
+                while len(out)<n+k:
+                    v=sum(a*out[-i] for i,a in enumerate(c,1)); out.append(v%m if m else v)
+                p0=st["pos"]; st["state"]=out[n:n+k]; st["pos"]=p0+n; left-=n
+                yield p0,out[:n]
+        return gen()
+
+    def compute(self,op:str,n:int,mod:Optional[int]=None,fmt:str="dec")->Dict:
+        t0=time.perf_counter()
+        ops={"fibonacci":lambda n:self.fibonacci(n,mod,fmt),"collatz":self.collatz,
+             "pascal":self.pascal,"lucas":lambda n:self.lucas(n,mod,fmt),"tribonacci":lambda n:self.tribonacci(n,mod,fmt)}
         fn=ops.get(op)
         if not fn: return {"error":f"Operação inválida. Use: {list(ops)}"}
-        result=fn(n)
+        try: result=fn(n)
+        except ValueError as e: return {"error":str(e)}
         result["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
         return result
 
 
+# ══════════════════════════════════════════════════════════════════════════════
+#  7b. BINOMIAL ENGINE
+# ══════════════════════════════════════════════════════════════════════════════
+class BinomialEngine:
+    """C(n, k) exato (inteiros grandes) ou mod m. Mod m: m é fatorado e cada
+    potência de primo q = p^e usa uma tabela F[i] = ∏ j (j <= i, p ∤ j) mod q,
+    montada uma vez e guardada em cache. Com ela, n! sem os fatores p sai de
+    log_p(n) consultas (Lucas generalizado/Granville), o expoente de p sai da
+    soma de dígitos (Kummer) e as potências se juntam por CRT. Tudo em lanes
+    uint64, então consultas em lote custam O(log_p n) operações vetorizadas."""
+    FACT_MAX=1<<22          # maior tabela por potência de primo (32 MiB)
+    BIGP_WORK=10**8         # p > FACT_MAX: fatores da fórmula multiplicativa por bloco de lanes (~1.5 s)
+    TABLES_MAX=16
+    BATCH_CHUNK=1<<16
+    EXACT_N_MAX=10**6       # C(n, k) exato
+    ROW_EXACT_BITS=1<<25    # bits somados de uma linha exata (~10M dígitos decimais)
+    ROW_MOD_MAX=10**6       # termos por linha mod m
+    TRI_EXACT_MAX=2000      # linhas do triângulo exato
+
+    def __init__(self, nt:Optional['NumberTheoryEngine']=None, pool:Optional['WorkerPool']=None):
+        self.nt=nt or NumberTheoryEngine(pool); self.pool=self.nt.pool
+        self._tables:OrderedDict=OrderedDict(); self._lock=threading.Lock()
+
+    def _mm(self, a:np.ndarray, b:np.ndarray, q:int) -> np.ndarray:
+        return self.nt.pr._mulmod(a,b,np.array([q],dtype=np.uint64))
+
+    def _prefix_prod(self, a:np.ndarray, q:int) -> np.ndarray:
+        """Produtos prefixos mod q: a vira uma matriz B×L, cada linha acumula
+        em L passos vetorizados (grupos de linhas em paralelo no pool) e os
+        totais das linhas corrigem os prefixos no fim."""
+        N=len(a); L=math.isqrt(N)+1; B=-(-N//L)
+        M=np.ones(B*L,dtype=np.uint64); M[:N]=a%np.uint64(q); M=M.reshape(B,L)
+        def rows(r):
+            X=M[r]
+            for j in range(1,L): X[:,j]=self._mm(X[:,j-1],X[:,j],q)
+            M[r]=X
+        W=max(1,min(self.pool.threads,B)); step=-(-B//W)
+        self.pool.map(rows,[slice(i,i+step) for i in range(0,B,step)])
+        off=[1]
+        for t in M[:-1,-1].tolist(): off.append(off[-1]*t%q)
+        return self._mm(M,np.array(off,dtype=np.uint64)[:,None],q).ravel()[:N]
+
+    def _table(self, p:int, e:int) -> Tuple[np.ndarray,int]:
+        """(F, F[q-1]) para q = p^e; com e = 1 e p > FACT_MAX a tabela para em
+        FACT_MAX e as lanes com n além dela vão para _mod_bigp."""
+        key=(p,e); q=p**e
+        with self._lock:
+            if key in self._tables: self._tables.move_to_end(key); return self._tables[key]
+        if e>1 and q>self.FACT_MAX: raise ValueError(f"Potência de primo {p}^{e} > {self.FACT_MAX} no módulo")
+        T=min(q,self.FACT_MAX); a=np.arange(T,dtype=np.uint64); a[::p]=1
+        F=self._prefix_prod(a,q); r=(F,int(F[q-1]) if q<=T else q-1)   # Wilson: (p-1)! ≡ -1
+        with self._lock:
+            self._tables[key]=r
+            while len(self._tables)>self.TABLES_MAX: self._tables.popitem(last=False)
+        return r
+
+    def _mod_pe(self, n:np.ndarray, k:np.ndarray, p:int, e:int, F:np.ndarray, w:int) -> np.ndarray:
+        """C(n, k) mod p^e por lane (k <= n), com a tabela (F, w) de _table."""
+        q=p**e; P=np.uint64(p); Q=np.uint64(q)
+        if len(F)<q and len(n) and int(n.max())>=len(F):      # p > FACT_MAX: lanes além da tabela vão por Lucas
+            big=n>=np.uint64(len(F)); r=np.empty(len(n),dtype=np.uint64)
+            if not big.all(): r[~big]=self._mod_pe(n[~big],k[~big],p,e,F,w)
+            r[big]=self._mod_bigp(n[big],k[big],p,F)
+            return r
+        def fact(x):                         # x! sem os fatores p, mod q
+            acc=np.ones(len(x),dtype=np.uint64)%Q; x=x.copy()
+            while x.any():
+                acc=self._mm(acc,F[(x%Q).astype(np.intp)],q)
+                if w==q-1: acc=np.where((x//Q)&np.uint64(1)==1,(Q-acc)%Q,acc)
+                x//=P
+            return acc
+        def dsum(x):
+            s=np.zeros(len(x),dtype=np.uint64); x=x.copy()
+            while x.any(): s+=x%P; x//=P
+            return s
+        m=n-k; v=((dsum(k)+dsum(m)-dsum(n))//np.uint64(p-1)).astype(np.int64)
+        den,ok=self.nt.modinv_batch(self._mm(fact(k),fact(m),q),Q,workers=1)
+        r=self._mm(fact(n),den,q)
+        pw=np.array([pow(p,i,q) for i in range(e)]+[0],dtype=np.uint64)
+        return self._mm(r,pw[np.minimum(v,e)],q)
+
+    def _prod_range(self, lo:int, hi:int, p:int) -> int:
+        """lo·(lo+1)·…·hi mod p, em fatias reduzidas aos pares nas lanes."""
+        acc=1
+        for a in range(lo,hi+1,1<<22):
+            x=np.arange(a,min(hi,a+(1<<22)-1)+1,dtype=np.uint64)
+            while len(x)>1:
+                if len(x)&1: x=np.append(x,np.uint64(1))
+                x=self._mm(x[0::2],x[1::2],p)
+            acc=acc*int(x[0])%p
+        return acc
+
+    def _mod_bigp(self, n:np.ndarray, k:np.ndarray, p:int, F:np.ndarray) -> np.ndarray:
+        """C(n, k) mod p primo > FACT_MAX por Lucas: produto de C(n_i, k_i) sobre
+        os dígitos na base p. Dígito coberto pela tabela: F[n_i]/(F[k_i]·F[n_i-k_i]);
+        senão a fórmula multiplicativa com t = min(k_i, n_i-k_i) fatores e um
+        inverso, O(t) por dígito, com teto BIGP_WORK no bloco."""
+        T=len(F); lanes=[]; work=0
+        for ni,ki in zip(n.tolist(),k.tolist()):
+            d=[]
+            while ni: d.append((ni%p,ki%p)); ni//=p; ki//=p
+            if any(b>a for a,b in d): d=None          # algum dígito com k_i > n_i: C ≡ 0
+            else: work+=sum(min(b,a-b) for a,b in d if a>=T)
+            lanes.append(d)
+        if work>self.BIGP_WORK:
+            raise ValueError(f"Com p > {self.FACT_MAX}: soma de min(k_i, n_i-k_i) nos dígitos base p passa de {self.BIGP_WORK}")
+        out=np.zeros(len(lanes),dtype=np.uint64)
+        for i,d in enumerate(lanes):
+            if d is None: continue
+            r=1
+            for a,b in d:
+                if a<T: r=r*int(F[a])*pow(int(F[b])*int(F[a-b]),-1,p)%p
+                elif (t:=min(b,a-b)): r=r*self._prod_range(a-t+1,a,p)*pow(self._prod_range(1,t,p),-1,p)%p
+            out[i]=r
+        return out
+
+    def _factor(self, m:int) -> List[Tuple[int,int]]:
+        f=self.nt.pr.factorize(m)
+        if not f.get("complete",True): raise ValueError("Não foi possível fatorar m dentro do prazo")
+        return sorted(f["factorization"].items())
+
+    def mod_batch(self, n:np.ndarray, k:np.ndarray, m:int, workers:int=0) -> np.ndarray:
+        """C(n_i, k_i) mod m para arrays uint64 (k > n dá 0), blocos no pool."""
+        n,k=(np.ascontiguousarray(x,dtype=np.uint64) for x in np.broadcast_arrays(n,k))
+        if m<1 or m>=self.nt.pr.VEC_MAX: raise ValueError(f"m deve estar em [1, {self.nt.pr.VEC_MAX})")
+        if m==1: return np.zeros(len(n),dtype=np.uint64)
+        fac=self._factor(m)
+        tabs=[self._table(p,e) for p,e in fac]   # montadas fora das tarefas do pool
+        def run(i):
+            s=slice(i,i+self.BATCH_CHUNK); nn,kk=n[s],k[s]; bad=kk>nn; kk=np.where(bad,0,kk)
+            R=np.stack([self._mod_pe(nn,kk,p,e,*t) for (p,e),t in zip(fac,tabs)],axis=1)
+            x=R[:,0] if len(fac)==1 else self.nt.crt_batch(R,[p**e for p,e in fac],workers=1)
+            x[bad]=0
+            return x
+        return np.concatenate([np.zeros(0,dtype=np.uint64)]+self.pool.map(run,range(0,len(n),self.BATCH_CHUNK),workers=workers))
+
+    def nck(self, n:int, k:int, m:Optional[int]=None) -> int:
+        """C(n, k), exato ou mod m.
+
+        >>> BinomialEngine().nck(5_000_000, 2, 10**9+7) == 12499997500000 % (10**9+7)
+        True
+        """
+        if m is not None:
+            return int(self.mod_batch(np.array([n],dtype=np.uint64),np.array([k],dtype=np.uint64),m,workers=1)[0])
+        if n>self.EXACT_N_MAX: raise ValueError(f"Exato: n deve ser <= {self.EXACT_N_MAX} (use mod)")
+        return math.comb(n,k)
+
+    def row(self, n:int, lo:int, hi:int, m:Optional[int]=None, workers:int=0) -> List[int]:
+        """C(n, lo..hi): mod m em lote; exato pela fórmula multiplicativa
+        C(n, k+1) = C(n, k)·(n-k)/(k+1) a partir de C(n, lo). A linha exata é
+        limitada pelo tamanho da saída, estimado por log2 C(n, k) <= n·H(k/n)."""
+        hi=min(hi,n)
+        if hi<lo: return []
+        if m is not None:
+            if hi-lo+1>self.ROW_MOD_MAX: raise ValueError(f"Máximo de {self.ROW_MOD_MAX} termos por linha")
+            return self.mod_batch(np.uint64(n),np.arange(lo,hi+1,dtype=np.uint64),m,workers).tolist()
+        if n>self.EXACT_N_MAX: raise ValueError(f"Exato: n deve ser <= {self.EXACT_N_MAX} (use mod)")
+        p=np.arange(lo,hi+1,dtype=np.float64)/max(n,1); q=1-p
+        with np.errstate(divide="ignore",invalid="ignore"):
+            H=-np.where(p>0,p*np.log2(p),0)-np.where(q>0,q*np.log2(q),0)
+        if (bits:=float(n*H.sum())+hi-lo+1)>self.ROW_EXACT_BITS:
+            raise ValueError(f"Exato: a linha teria ~{int(bits)} bits (máximo {self.ROW_EXACT_BITS}); use mod ou uma faixa menor")
+        c=self.nck(n,lo); out=[c]
+        for j in range(lo,hi): c=c*(n-j)//(j+1); out.append(c)
+        return out
+
+    def triangle(self, r0:int, r1:int, m:Optional[int]=None, workers:int=0):
+        """Linhas r0..r1 do triângulo: a primeira pela fórmula, as seguintes
+        pela soma de vizinhos (mod m em uint64, ou inteiros exatos)."""
+        if m is None and r1>self.TRI_EXACT_MAX: raise ValueError(f"Exato: até a linha {self.TRI_EXACT_MAX} (use mod)")
+        if m is not None and r1>=self.ROW_MOD_MAX: raise ValueError(f"Mod m: até a linha {self.ROW_MOD_MAX-1}")
+        row=self.row(r0,0,r0,m,workers)
+        if m is not None: row=np.array(row,dtype=np.uint64); M=np.uint64(m)
+        for n in range(r0,r1+1):
+            yield n,row
+            if m is not None:
+                nx=np.empty(len(row)+1,dtype=np.uint64); nx[0]=nx[-1]=np.uint64(1%m)
+                nx[1:-1]=(row[:-1]+row[1:])%M; row=nx
+            else: row=[1]+[a+b for a,b in zip(row,row[1:])]+[1]
+
+    def compute(self, op:str, n:int, k:int=0, lo:int=0, hi:Optional[int]=None, m:Optional[int]=None, fmt:str="dec") -> Dict:
+        t0=time.perf_counter(); big=lambda x:x if x.bit_length()<=13000 else SequenceEngine._to_str(x,fmt)
+        try:
+            if op=="nck": r={"n":n,"k":k,"value":big(self.nck(n,k,m)) if k<=n else 0}
+            elif op=="row":
+                h=n if hi is None else hi
+                r={"n":n,"lo":lo,"hi":min(h,n),"row":[big(x) for x in self.row(n,lo,h,m)]}
+            else: return {"error":"Operação inválida. Use: ['nck', 'row']"}
+        except ValueError as e: return {"error":str(e)}
+        if m is not None: r["mod"]=m
+        r["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
+        return r
+
+
 # ══════════════════════════════════════════════════════════════════════════════
 #  8. STATISTICS ENGINE
 # ══════════════════════════════════════════════════════════════════════════════
 class StatsEngine:
-    def analyze(self, data:List[float]) -> Dict:
-        if not data: return {"error":"Lista vazia"}
-        t0=time.perf_counter()
-        arr=np.array(data,dtype=float)
-        n=len(arr)
-        sl=sorted(data)
-        def pct(p): return float(np.percentile(arr,p))
+    """analyze: uma passada em blocos que cabem no cache (n, min, max, soma e
+    momentos centrais até o 4º, combinados bloco a bloco pelas fórmulas de
+    Welford/Pébay) e uma única seleção múltipla (np.partition com todos os
+    postos) para mediana e percentis."""
+    BLOCK=1<<15                 # 256 KiB de float64 por bloco
+    PCTS=(25,50,75,90,99)
+
+    def __init__(self, pool:Optional['WorkerPool']=None):
+        self.pool=pool
+
+    @staticmethod
+    def _merge(a:Tuple, b:Tuple) -> Tuple:
+        """(n, mean, M2, M3, M4, min, max, sum) de a ∪ b."""
+        na,ma,A2,A3,A4,lo,hi,sa=a; nb,mb,B2,B3,B4,lo2,hi2,sb=b
+        if not na: return b
+        n=na+nb; d=mb-ma; dn=d/n; ab=na*nb
+        M2=A2+B2+d*dn*ab
+        M3=A3+B3+d*dn*dn*ab*(na-nb)+3*dn*(na*B2-nb*A2)
+        M4=(A4+B4+d*dn*dn*dn*ab*(na*na-ab+nb*nb)+6*dn*dn*(na*na*B2+nb*nb*A2)
+            +4*dn*(na*B3-nb*A3))
+        return n,ma+dn*nb,M2,M3,M4,min(lo,lo2),max(hi,hi2),sa+sb
+
+    def _moments(self, arr:np.ndarray) -> Tuple:
+        acc=(0,0.0,0.0,0.0,0.0,math.inf,-math.inf,0.0)
+        for i in range(0,len(arr),self.BLOCK):
+            x=arr[i:i+self.BLOCK].astype(np.float64,copy=False); s=float(x.sum()); m=s/len(x)
+            d=x-m; d2=d*d
+            acc=self._merge(acc,(len(x),m,float(d2.sum()),float((d2*d).sum()),float((d2*d2).sum()),
+                                 float(x.min()),float(x.max()),s))
+        return acc
+
+    def analyze(self, data, workers:int=0) -> Dict:
+        arr=np.asarray(data,dtype=float) if not isinstance(data,np.ndarray) else data
+        if not len(arr): return {"error":"Lista vazia"}
+        t0=time.perf_counter(); n=len(arr)
+        step=-(-n//max(1,workers or (self.pool.threads if self.pool else 1)))
+        step=-(-max(step,self.BLOCK)//self.BLOCK)*self.BLOCK
+        parts=(self.pool.map if self.pool else lambda f,it,workers=0:list(map(f,it)))(
+            lambda i:self._moments(arr[i:i+step]),range(0,n,step),workers=workers)
+        acc=parts[0]
+        for p in parts[1:]: acc=self._merge(acc,p)
+        _,mean,M2,M3,M4,lo,hi,tot=acc
+        # min/max do merge descartam NaN (min(1.0, nan) = 1.0); a soma o propaga, assim como ±inf
+        if not math.isfinite(tot): return {"error":"Dados com NaN ou infinito"}
+        var=M2/n; std=math.sqrt(var)
+        h={p:(n-1)*p/100 for p in self.PCTS}
+        ks=sorted({i for x in h.values() for i in (math.floor(x),math.ceil(x))})
+        sel=np.partition(arr,ks)
+        def pct(p):
+            i=math.floor(h[p]); a=float(sel[i]); return a+(float(sel[math.ceil(h[p])])-a)*(h[p]-i)
+        P={p:pct(p) for p in self.PCTS}
         result={
-            "count":n,"min":round(float(arr.min()),8),"max":round(float(arr.max()),8),
-            "mean":round(float(arr.mean()),8),"median":round(float(np.median(arr)),8),
-            "std":round(float(arr.std()),8),"variance":round(float(arr.var()),8),
-            "sum":round(float(arr.sum()),8),"range":round(float(arr.max()-arr.min()),8),
-            "percentiles":{"p25":round(pct(25),8),"p50":round(pct(50),8),
-                           "p75":round(pct(75),8),"p90":round(pct(90),8),"p99":round(pct(99),8)},
-            "skewness":round(float(((arr-arr.mean())**3).mean()/arr.std()**3) if arr.std()>0 else 0,6),
-            "kurtosis":round(float(((arr-arr.mean())**4).mean()/arr.std()**4-3) if arr.std()>0 else 0,6),
+            "count":n,"min":round(lo,8),"max":round(hi,8),
+            "mean":round(mean,8),"median":round(P[50],8),
+            "std":round(std,8),"variance":round(var,8),
+            "sum":round(tot,8),"range":round(hi-lo,8),
+            "percentiles":{f"p{p}":round(P[p],8) for p in self.PCTS},
+            "skewness":round(M3/n/std**3 if std>0 else 0,6),
+            "kurtosis":round(M4/n/var**2-3 if std>0 else 0,6),
         }
         result["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
         return result
@@ -585,3 +3003,103 @@ class MetricsCollector:
                 "throughput_ops_sec":round(ops/uptime,2),
                 "by_module":by_m,"cpu_percent":round(cpu,2),
                 "memory_bytes":mem,"uptime_seconds":int(uptime)}
+
+
+# ══════════════════════════════════════════════════════════════════════════════
+#  10. WORKER POOL
+# ══════════════════════════════════════════════════════════════════════════════
+class WorkerPool:
+    """Pool de threads compartilhado pelos engines. Os kernels NumPy liberam o
+    GIL, então blocos independentes rodam de fato em paralelo entre os núcleos.
+    Tarefas do pool não devem submeter novas tarefas ao mesmo pool."""
+    def __init__(self, threads:int=0):
+        self.threads=max(1,threads or os.cpu_count() or 1)
+        self._lock=threading.Lock(); self._ex:Optional[ThreadPoolExecutor]=None
+
+    def resize(self, threads:int):
+        with self._lock:
+            old,self._ex=self._ex,None
+            self.threads=max(1,threads or os.cpu_count() or 1)
+        if old: old.shutdown(wait=False)
+
+    def _executor(self)->ThreadPoolExecutor:
+        with self._lock:
+            if self._ex is None:
+                self._ex=ThreadPoolExecutor(self.threads,thread_name_prefix="nexus-worker")
+            return self._ex
+
+    def map(self, fn, *its, workers:int=0) -> List:
+        """Como map(), mas no pool; workers=1 (ou pool de 1 thread) roda inline."""
+        if min(workers or self.threads,self.threads)<=1: return list(map(fn,*its))
+        return list(self._executor().map(fn,*its))
+
+    def shutdown(self):
+        with self._lock: old,self._ex=self._ex,None
+        if old: old.shutdown(wait=True)
+
+
+class MemoryBudget:
+    """Orçamento de memória compartilhado entre requisições: cada job reserva
+    os bytes que vai ocupar antes de alocar e devolve ao terminar. Sem espaço,
+    a reserva falha na hora em vez de deixar o processo crescer."""
+    def __init__(self, nbytes:int):
+        self.total=nbytes; self.used=0; self.peak=0; self.rejected=0; self._lock=threading.Lock()
+
+    def reserve(self, nbytes:int):
+        with self._lock:
+            if self.used+nbytes>self.total:
+                self.rejected+=1
+                raise ValueError(f"Orçamento de memória esgotado: {nbytes} bytes pedidos, "
+                                 f"{self.total-self.used} de {self.total} livres")
+            self.used+=nbytes; self.peak=max(self.peak,self.used)
+
+    def release(self, nbytes:int):
+        with self._lock: self.used=max(0,self.used-nbytes)
+
+    @contextmanager
+    def hold(self, nbytes:int):
+        self.reserve(nbytes)
+        try: yield
+        finally: self.release(nbytes)
+
+    def info(self) -> Dict:
+        with self._lock: return {"total":self.total,"used":self.used,"peak":self.peak,"rejected":self.rejected}
+
+
+# ══════════════════════════════════════════════════════════════════════════════
+#  11. STREAM CODECS
+# ══════════════════════════════════════════════════════════════════════════════
+class ArrayDecoder:
+    """Decodifica um corpo recebido em pedaços em blocos np.ndarray, sem
+    materializar o corpo inteiro. fmt="binary": valores little-endian do dtype;
+    fmt="text": números separados por espaço, vírgula ou quebra de linha
+    (cobre CSV, NDJSON de escalares e arrays JSON). null vira NaN."""
+    FORMATS=["text","binary"]
+    _SEPS=(b"\n",b"\r",b"\t",b" ",b",",b"[",b"]")
+
+    def __init__(self, fmt:str="text", dtype:str="float64"):
+        if fmt not in self.FORMATS: raise ValueError(f"Formato inválido. Use: {self.FORMATS}")
+        self.fmt=fmt; self.dtype=np.dtype(dtype).newbyteorder("<")
+        self._tail=b""; self.bytes_in=0; self.count=0
+
+    def feed(self, chunk:bytes) -> np.ndarray:
+        self.bytes_in+=len(chunk); buf=self._tail+chunk
+        if self.fmt=="binary": cut=len(buf)-len(buf)%self.dtype.itemsize
+        else: cut=max(buf.rfind(s) for s in self._SEPS)+1
+        self._tail=buf[cut:]
+        return self._decode(buf[:cut])
+
+    def close(self) -> np.ndarray:
+        t,self._tail=self._tail,b""
+        if self.fmt=="binary" and t: raise ValueError("Corpo binário truncado")
+        return self._decode(t)
+
+    def _decode(self, b:bytes) -> np.ndarray:
+        if self.fmt=="binary": a=np.frombuffer(b,dtype=self.dtype)
+        else:
+            for s in (b",",b"[",b"]"): b=b.replace(s,b" ")
+            toks=b.replace(b"null",b"nan").split()
+            if self.dtype.kind!="f" and b"nan" in toks: raise ValueError("NaN exige dtype float")
+            a=np.array(toks,dtype=self.dtype)
+        self.count+=len(a)
+        return a
@@ -1,12 +1,17 @@
 """Services — NexusEngine Omega v3.0 | Autor: Emanuel Felipe"""
-import time, threading, random, logging
+import os, time, threading, random, logging, asyncio, uuid, tempfile, shutil, json, itertools
+import numpy as np
+from collections import OrderedDict
 from typing import Optional, List
 from datetime import datetime
 from .engine_core import (BinaryProcessor, MatrixEngine, QuantumSimulator,
-    HashEngine, SortEngine, PrimeEngine, SequenceEngine, StatsEngine, MetricsCollector)
+    HashEngine, SortEngine, PrimeEngine, NumberTheoryEngine, SequenceEngine, BinomialEngine, StatsEngine, MetricsCollector,
+    WorkerPool, MemoryBudget, TopKStream, ArrayDecoder, ExternalSorter, RunMerger, SortBenchmark)
 
 logger = logging.getLogger(__name__)
 
+worker_pool = WorkerPool()
+
 class EngineService:
     def __init__(self):
         self.is_running=False; self.threads=0; self.started_at=None
@@ -16,6 +21,7 @@ class EngineService:
         try:
             self._stop_event.clear()
             self.is_running=True; self.threads=threads
+            worker_pool.resize(threads)
             self.started_at=datetime.utcnow()
             logger.info(f"Engine iniciado — {threads} workers")
             return True
@@ -24,6 +30,7 @@ class EngineService:
 
     def stop(self)->bool:
         self._stop_event.set(); self.is_running=False
+        worker_pool.shutdown()
         logger.info("Engine parado"); return True
 
     def get_status(self)->dict:
@@ -35,9 +42,14 @@ class EngineService:
 class ComputeService:
     def __init__(self):
         self.bp=BinaryProcessor(); self.mx=MatrixEngine()
-        self.ha=HashEngine(); self.so=SortEngine()
-        self.pr=PrimeEngine(); self.sq=SequenceEngine()
-        self.st=StatsEngine()
+        self.ha=HashEngine(); self.so=SortEngine(worker_pool)
+        self.pr=PrimeEngine(worker_pool); self.nt=NumberTheoryEngine(worker_pool,self.pr)
+        self.sq=SequenceEngine(worker_pool)
+        self.bi=BinomialEngine(self.nt)
+        self.st=StatsEngine(worker_pool)
+        self.stats_budget=MemoryBudget(int(os.getenv("NEXUS_STATS_MEMORY_MB","512"))<<20)
+        self.budget=MemoryBudget(int(os.getenv("NEXUS_MEMORY_MB","2048"))<<20)   # jobs em memória (sort, collatz)
+        self._ext_jobs:OrderedDict=OrderedDict()
         logger.info("ComputeService pronto")
 
     def binary(self,op,a,b=0):      return self.bp.compute(op,a,b)
@@ -74,13 +86,404 @@ class ComputeService:
     def hash_verify(self,data,exp,algo): return self.ha.verify(data,exp,algo)
     def hmac(self,key,data,algo):   return self.ha.hmac(key,data,algo)
 
-    def sort(self,data,algo):       return self.so.sort(data,algo)
+    def sort(self,data,algo,workers=0,**kw):return self.so.sort(data,algo,workers,**kw)
+    def sort_parallel(self,data,size,workers):
+        """Pico ~4 arrays do tamanho da entrada: entrada, saída, buckets do
+        sample sort e a cópia do np.sort serial de referência."""
+        try:
+            with self.budget.hold(32*(len(data) if data else size)): return self.so.parallel(data,size,workers)
+        except ValueError as e: return {"error":str(e)}
     def sort_benchmark(self,data):  return self.so.benchmark(data)
+    def sort_benchmark_suite(self,**kw):return SortBenchmark().run(**kw)
+    def sort_segmented(self,values,offsets,dtype="auto",workers=0,gen_segments=0,gen_max_len=64,limit=1000):
+        if gen_segments:
+            if gen_segments*gen_max_len>50_000_000: return {"error":"generate_segments·generate_max_len deve ser <= 5e7"}
+            need=24*gen_segments*gen_max_len+16*gen_segments     # pior caso: valores, ids e saída; offsets
+        elif values is None or offsets is None: return {"error":"Informe values e offsets, ou generate_segments"}
+        else: need=24*len(values)+16*len(offsets)
+        try:
+            with self.budget.hold(need):
+                if gen_segments:
+                    ln=np.random.randint(0,gen_max_len+1,gen_segments)
+                    offsets=np.concatenate(([0],np.cumsum(ln)))
+                    values=np.random.randint(-2**31,2**31,int(offsets[-1]),dtype=np.int64)
+                r=self.so.segmented(values,offsets,dtype,workers)
+        except ValueError as e: return {"error":str(e)}
+        if "error" not in r: r["values"]=self.so._jsonable(r["values"][:limit])
+        return r
+    def sort_select(self,op,data,**kw):return self.so.select(op,data,**kw)
+
+    async def sort_topk_stream(self,chunks,k,largest,fmt,dtype):
+        """Top-k sobre um corpo em streaming, em memória O(k + bloco)."""
+        t0=time.perf_counter()
+        try: dec=ArrayDecoder(fmt,dtype)
+        except Exception as e: return {"error":str(e)}
+        acc=TopKStream(k,largest)
+        try:
+            async for b in chunks: acc.push(dec.feed(b))
+            acc.push(dec.close())
+        except ValueError as e: return {"error":str(e)}
+        top=acc.result()
+        return {"operation":"topk","k":k,"largest":largest,"input_size":acc.seen,
+                "bytes_in":dec.bytes_in,"values":self.so._jsonable(top),"backend":"native",
+                "latency_us":round((time.perf_counter()-t0)*1e6,4)}
+
+    # ── Sort externo ────────────────────────────────────────────────────────
+    # NEXUS_SORT_MEMORY_MB: orçamento padrão por job · NEXUS_SPILL_DIR: onde as
+    # runs são despejadas · NEXUS_DATA_DIR: raiz dos datasets no servidor
+    @staticmethod
+    def data_path(name:str)->str:
+        root=os.path.realpath(os.getenv("NEXUS_DATA_DIR","data"))
+        p=os.path.realpath(os.path.join(root,name))
+        if not p.startswith(root+os.sep): raise ValueError("Caminho fora de NEXUS_DATA_DIR")
+        if not os.path.isfile(p): raise ValueError(f"Arquivo não encontrado: {name}")
+        return p
+
+    @staticmethod
+    def _ingest_file(path,dec,sink,chunk=8<<20):
+        with open(path,"rb") as f:
+            while b:=f.read(chunk): sink(dec.feed(b))
+        sink(dec.close())
+
+    @staticmethod
+    def encode_block(a,out_fmt):
+        if out_fmt=="binary": return a.astype(a.dtype.newbyteorder("<"),copy=False).tobytes()
+        return ("\n".join(map(str,a.tolist()))+"\n").encode()
+
+    async def sort_external(self,chunks,fmt,dtype,memory_mb=0,path=None,out_fmt="binary"):
+        """Fase de runs consumindo o corpo (ou um arquivo do servidor); devolve
+        o resumo e um gerador que faz o merge enquanto a resposta é enviada."""
+        t0=time.perf_counter()
+        try:
+            dec=ArrayDecoder(fmt,dtype)
+            ext=ExternalSorter(dtype,(memory_mb or int(os.getenv("NEXUS_SORT_MEMORY_MB","256")))<<20,
+                               os.getenv("NEXUS_SPILL_DIR") or None,self.so)
+        except Exception as e: return {"error":str(e)},None
+        try:
+            if path: await asyncio.to_thread(self._ingest_file,self.data_path(path),dec,ext.add)
+            else:
+                async for b in chunks: await asyncio.to_thread(lambda b=b:ext.add(dec.feed(b)))
+                await asyncio.to_thread(lambda:ext.add(dec.close()))
+        except (ValueError,OSError) as e:
+            ext.cleanup(); return {"error":str(e)},None
+        info={"status":"merging","input_size":ext.count,"bytes_in":dec.bytes_in,
+              "memory_bytes":ext.mem,"metrics":ext.metrics,"run_phase_us":round((time.perf_counter()-t0)*1e6,4)}
+        return info,self._job_stream(info,ext.merge(),out_fmt)
+
+    def _job_stream(self,info,blocks,out_fmt,done=None):
+        """Registra o job e devolve o gerador da resposta, que fecha o resumo ao terminar."""
+        info["job"]=uuid.uuid4().hex[:12]
+        self._ext_jobs[info["job"]]=info
+        while len(self._ext_jobs)>64: self._ext_jobs.popitem(last=False)
+        def gen():
+            t=time.perf_counter()
+            try:
+                for blk in blocks: yield self.encode_block(blk,out_fmt)
+                info["status"]="done"
+            except Exception as e: info.update(status="error",error=str(e)); raise
+            finally:
+                info["merge_phase_us"]=round((time.perf_counter()-t)*1e6,4)
+                if done: done()
+        return gen()
+
+    def sort_external_job(self,job): return self._ext_jobs.get(job)
+
+    # ── Merge de runs já ordenadas ──────────────────────────────────────────
+    def _merger(self,src,dtype,dedup,workers,memory_mb,check=True):
+        mem=(memory_mb or int(os.getenv("NEXUS_SORT_MEMORY_MB","256")))<<20
+        blk=max(4096,mem//(np.dtype(dtype).itemsize*(2*max(len(src),1)+2)))
+        return RunMerger([s(blk) for s in src],dtype,dedup,workers,self.so,check=check),mem,blk
+
+    def sort_merge(self,runs=None,paths=None,fmt="binary",dtype="float64",dedup=False,
+                   workers=0,memory_mb=0,out_fmt="binary"):
+        """K vias sobre runs inline ou arquivos do servidor; a saída sai em blocos."""
+        if (runs is None)==(paths is None): return {"error":"Informe runs ou paths"},None
+        try:
+            if runs is not None:
+                arr=[np.asarray(r,dtype=dtype) for r in runs]
+                src=[lambda blk,a=a:[a] for a in arr]; n=sum(len(a) for a in arr)
+            else:
+                files=[self.data_path(p) for p in paths]
+                src=[lambda blk,f=f:RunMerger.file_source(f,fmt,dtype,blk) for f in files]
+                n=None
+            # a ordem é conferida antes da resposta: no meio do stream o erro só cortaria o corpo
+            for i,s in enumerate(src):
+                if not RunMerger.is_sorted(s(1<<16)): return {"error":f"Run {i} não está ordenada"},None
+        except (ValueError,OSError) as e: return {"error":str(e)},None
+        mr,mem,blk=self._merger(src,dtype,dedup,workers,memory_mb,check=False)
+        info={"status":"merging","runs":len(src),"input_size":n,"dedup":dedup,
+              "memory_bytes":mem,"block_elems":blk,"metrics":mr.metrics}
+        return info,self._job_stream(info,mr.merge(),out_fmt)
+
+    async def sort_merge_stream(self,chunks,lengths,fmt,dtype,dedup=False,workers=0,memory_mb=0,out_fmt="binary"):
+        """Runs concatenadas no corpo, com os tamanhos em lengths: cada run vai
+        para um arquivo temporário ao chegar e o merge lê dos arquivos."""
+        t0=time.perf_counter()
+        try: dec=ArrayDecoder(fmt,dtype)
+        except Exception as e: return {"error":str(e)},None
+        d=tempfile.mkdtemp(prefix="nexus-merge-",dir=os.getenv("NEXUS_SPILL_DIR") or None)
+        files=[os.path.join(d,f"run{i:05d}.bin") for i in range(len(lengths))]
+        st={"i":0,"left":lengths[0] if lengths else 0,"f":None,"last":None}
+        def sink(a):
+            while len(a):
+                while st["left"]==0 and st["i"]<len(lengths)-1: st["i"]+=1; st["left"]=lengths[st["i"]]
+                if st["left"]==0: raise ValueError("Corpo maior que a soma de lengths")
+                if st["f"] is None or st["f"].name!=files[st["i"]]:
+                    if st["f"]: st["f"].close()
+                    st["f"]=open(files[st["i"]],"wb"); st["last"]=None
+                take=min(len(a),st["left"])
+                # ordem conferida na chegada, antes da resposta começar (NaN fica de fora, como no merge)
+                v=a[:take][~np.isnan(a[:take])] if a.dtype.kind=="f" else a[:take]
+                if len(v):
+                    if (st["last"] is not None and v[0]<st["last"]) or np.any(v[1:]<v[:-1]):
+                        raise ValueError(f"Run {st['i']} não está ordenada")
+                    st["last"]=v[-1]
+                a[:take].astype(dec.dtype,copy=False).tofile(st["f"])
+                st["left"]-=take; a=a[take:]
+        try:
+            async for b in chunks: await asyncio.to_thread(sink,dec.feed(b))
+            sink(dec.close())
+            if dec.count!=sum(lengths): raise ValueError(f"Corpo com {dec.count} valores; lengths soma {sum(lengths)}")
+        except (ValueError,OSError) as e:
+            shutil.rmtree(d,True); return {"error":str(e)},None
+        finally:
+            if st["f"]: st["f"].close()
+        src=[lambda blk,f=f:RunMerger.file_source(f,"binary",dec.dtype.str,blk) if os.path.exists(f) else [] for f in files]
+        mr,mem,blk=self._merger(src,dtype,dedup,workers,memory_mb,check=False)
+        info={"status":"merging","runs":len(files),"input_size":dec.count,"bytes_in":dec.bytes_in,"dedup":dedup,
+              "memory_bytes":mem,"block_elems":blk,"metrics":mr.metrics,
+              "spill_phase_us":round((time.perf_counter()-t0)*1e6,4)}
+        return info,self._job_stream(info,mr.merge(),out_fmt,lambda:shutil.rmtree(d,True))
+
+    def prime(self,op,n,limit=1000,rounds=0,budget_ms=5000):return self.pr.compute(op,n,limit,rounds,budget_ms)
+    def prime_range(self,lo,hi,cursor=None,limit=1_000_000,fmt="ndjson",workers=0):
+        """Primos de [cursor or lo, hi] em NDJSON, um bloco por linha (primes ou
+        first + deltas); a última linha traz done, count e next_cursor, que
+        retoma a consulta de onde a página parou."""
+        start=lo if cursor is None else cursor
+        if not lo<=start<=hi+1: return {"error":"cursor fora de [lo, hi+1]"},None
+        try: it=self.pr.iter_range(start,hi,workers)
+        except ValueError as e: return {"error":str(e)},None
+        def gen():
+            t0=time.perf_counter(); n=0; nxt=last=None
+            for p in it:
+                cut=n+len(p)>limit
+                if cut: p=p[:limit-n]
+                if len(p):
+                    line={"primes":p.tolist()} if fmt=="ndjson" else {"first":int(p[0]),"deltas":np.diff(p).tolist()}
+                    yield (json.dumps(line,separators=(",",":"))+"\n").encode()
+                    n+=len(p); last=int(p[-1])
+                if cut: nxt=last+1; break
+            yield (json.dumps({"done":nxt is None,"count":n,"lo":lo,"hi":hi,"next_cursor":nxt,
+                               "latency_us":round((time.perf_counter()-t0)*1e6,4)})+"\n").encode()
+        return {"lo":lo,"hi":hi,"start":start},gen()
+
+    async def _read_body(self,chunks,dec):
+        """Corpo decodificado inteiro, com cada bloco reservado em self.budget ao
+        chegar (2 bytes por byte: o bloco e a concatenação). Devolve (array,
+        bytes reservados); quem chama libera. Em erro, libera antes de relançar."""
+        parts=[]; held=0
+        try:
+            async for b in chunks:
+                a=dec.feed(b); self.budget.reserve(2*a.nbytes); held+=2*a.nbytes; parts.append(a)
+            a=dec.close(); self.budget.reserve(2*a.nbytes); held+=2*a.nbytes; parts.append(a)
+        except BaseException: self.budget.release(held); raise
+        return np.concatenate(parts).astype(np.uint64,copy=False),held
+
+    async def prime_batch(self,chunks,op,fmt="binary",workers=0):
+        """is_prime/factorize sobre um corpo de inteiros uint64. Devolve o resumo
+        e o resultado empacotado: bitmap (bit i = a[i] é primo, LSB primeiro) ou
+        CSR com offsets e fatores, ambos uint64 little-endian. Corpo e trabalho
+        passam pelo orçamento NEXUS_MEMORY_MB."""
+        t0=time.perf_counter()
+        if op not in ("is_prime","factorize"): return {"error":"Operação inválida. Use: ['is_prime', 'factorize']"},None
+        try:
+            dec=ArrayDecoder(fmt,"uint64"); a,held=await self._read_body(chunks,dec)
+        except (ValueError,OverflowError) as e: return {"error":str(e)},None
+        try:
+            if op=="is_prime":
+                self.budget.reserve(16*len(a)); held+=16*len(a)
+                r=await asyncio.to_thread(self.pr.is_prime_batch,a,workers)
+                info={"operation":op,"count":len(a),"primes":int(r.sum())}; packed=(np.packbits(r,bitorder="little"),r)
+            else:
+                # a tem no máximo log2(a) fatores; ~40 bytes por fator no pico (listas, concatenação, lexsort)
+                need=40*int(np.floor(np.log2(np.maximum(a,1).astype(np.float64))).sum())+64*len(a)
+                self.budget.reserve(need); held+=need
+                off,fv,inc=await asyncio.to_thread(self.pr.factorize_batch,a,workers)
+                info={"operation":op,"count":len(a),"factor_count":len(fv),"incomplete":inc.tolist()}; packed=(off.astype("<u8"),fv.astype("<u8"))
+        except ValueError as e: return {"error":str(e)},None
+        finally: self.budget.release(held)
+        info["bytes_in"]=dec.bytes_in; info["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
+        return info,packed
 
-    def prime(self,op,n,limit=1000):return self.pr.compute(op,n,limit)
-    def sequence(self,op,n):        return self.sq.compute(op,n)
+    def prime_goldbach(self,n,lo=4,workers=0):
+        """r(m) para todo m par até n. Devolve o resumo e a janela [lo, n] (uint32)."""
+        t0=time.perf_counter()
+        try: r=self.pr.goldbach_counts(n,workers)
+        except ValueError as e: return {"error":str(e)},None
+        b=3 if len(r)>3 else 2                      # n = 4 ou 5: só r(4) = 1 (2+2)
+        v=r[b:]; i,j=int(v.argmin()),int(v.argmax())
+        info={"n":n,"evens":len(r)-2,"min":{"n":2*(i+b),"r":int(v[i])},"max":{"n":2*(j+b),"r":int(v[j])},
+              "violations":[2*int(k) for k in np.nonzero(r[2:]==0)[0]+2][:100],"lo":lo+lo%2,
+              "latency_us":round((time.perf_counter()-t0)*1e6,4)}
+        return info,r[(lo+1)//2:].astype("<u4")
+
+    # NEXUS_PRIME_TABLE_FILE: tabela de primos persistida; mapeada na subida,
+    # regravada na parada se o processo a estendeu
+    def prime_table_load(self):
+        path=os.getenv("NEXUS_PRIME_TABLE_FILE")
+        if not path or not os.path.exists(path): return
+        try:
+            if self.pr.table.load(path): logger.info(f"Tabela de primos mapeada de {path} até {self.pr.table.limit}")
+        except (OSError,ValueError) as e: logger.warning(f"Tabela de primos ignorada: {e}")
+
+    def prime_table_save(self,limit=0):
+        t0=time.perf_counter(); tb=self.pr.table
+        path=os.getenv("NEXUS_PRIME_TABLE_FILE")
+        if not path: return {"error":"NEXUS_PRIME_TABLE_FILE não configurado"}
+        try:
+            if limit: tb.ensure(limit)
+            # não regrava o mesmo conteúdo nem encolhe um arquivo que outro worker estendeu
+            if tb.limit<=max(1,tb.stored_limit(path)): r={"path":path,"saved":False}
+            else: r={**tb.save(path),"saved":True}
+        except (OSError,ValueError) as e: return {"error":str(e)}
+        return {**r,"table":tb.info(),"latency_us":round((time.perf_counter()-t0)*1e6,4)}
+
+    def prime_table(self): return self.pr.table.info()
+
+    def prime_count(self,lo,hi,workers=0,scaling=False):
+        t0=time.perf_counter()
+        try: r=self.pr.count_range(lo,hi,workers,scaling)
+        except ValueError as e: return {"error":str(e)}
+        return {"lo":lo,"hi":hi,**r,"latency_us":round((time.perf_counter()-t0)*1e6,4)}
+
+    def number_theory(self,op,a=0,b=0,m=1,residues=None,moduli=None):
+        return self.nt.compute(op,a,b,m,residues,moduli)
+
+    async def number_theory_batch(self,chunks,op,fmt="binary",mod=None,moduli=None,workers=0):
+        """modpow/modinv/crt sobre registros uint64 no corpo: modpow (b, e, m),
+        modinv (a, m), crt uma linha de resíduos por valor; com mod= o módulo
+        comum sai dos registros. Devolve o resumo e (resultados, ok). Corpo e
+        trabalho passam pelo orçamento NEXUS_MEMORY_MB."""
+        t0=time.perf_counter()
+        arity={"modpow":2 if mod else 3,"modinv":1 if mod else 2,"crt":len(moduli or [])}.get(op)
+        if arity is None: return {"error":"Operação inválida. Use: ['modpow', 'modinv', 'crt']"},None
+        if not arity: return {"error":"crt em lote exige moduli"},None
+        try:
+            dec=ArrayDecoder(fmt,"uint64"); a,held=await self._read_body(chunks,dec)
+        except (ValueError,OverflowError) as e: return {"error":str(e)},None
+        try:
+            if len(a)%arity: return {"error":f"{op}: o corpo deve ter registros de {arity} valores"},None
+            R=a.reshape(-1,arity); ok=None; M=np.uint64(mod or 0)
+            self.budget.reserve(4*a.nbytes); held+=4*a.nbytes      # lanes e resultado: ~3.3x o corpo medido
+            if op=="modpow": r=await asyncio.to_thread(self.nt.modpow_batch,R[:,0],R[:,1],M if mod else R[:,2],workers)
+            elif op=="modinv": r,ok=await asyncio.to_thread(self.nt.modinv_batch,R[:,0],M if mod else R[:,1],workers)
+            else: r=await asyncio.to_thread(self.nt.crt_batch,R,moduli,workers)
+        except ValueError as e: return {"error":str(e)},None
+        finally: self.budget.release(held)
+        info={"operation":op,"count":len(r),"bytes_in":dec.bytes_in}
+        if ok is not None: info["failed"]=int((~ok).sum())
+        info["latency_us"]=round((time.perf_counter()-t0)*1e6,4)
+        return info,(r.astype("<u8"),ok)
+
+    def sequence(self,op,n,mod=None,fmt="dec"): return self.sq.compute(op,n,mod,fmt)
+    def recurrence(self,**kw):      return self.sq.recurrence(**kw)
+    def recurrence_infer(self,terms,mod=None): return self.sq.infer(terms,mod)
+
+    def collatz_range(self,a,b,workers=0):
+        """Admitido pelo orçamento NEXUS_MEMORY_MB: ~COLLATZ_BYTES por início."""
+        try:
+            n=b-a+1 if 0<b-a+1<=self.sq.COLLATZ_SPAN_MAX else 0       # fora disso o motor recusa
+            with self.budget.hold(self.sq.COLLATZ_BYTES*n):
+                return self.sq.collatz_range(a,b,workers)
+        except ValueError as e: return {"error":str(e)}
+
+    def sequence_stream(self,op,pos=0,count=1000,coeffs=None,init=None,mod=None,seed=None,cursor=None,chunk=4096,fmt="ndjson"):
+        """Termos de uma sequência a partir de pos (ou de um cursor), em NDJSON
+        ({"pos", "terms"} por bloco; a última linha traz count e next_cursor)
+        ou uint64 empacotado, com o próximo cursor (só de posição) no resumo."""
+        try:
+            st=self.sq.stream_open(op,pos,coeffs,init,mod,seed,cursor)
+            if fmt=="binary" and (st["op"]=="collatz" or st["mod"] is None or st["mod"]>2**64):
+                return {"error":"binary exige uma recorrência com mod <= 2^64"},None
+            p0=st["pos"]; it=self.sq.stream(st,count,chunk)
+        except ValueError as e: return {"error":str(e)},None
+        info={"operation":st["op"],"pos":p0,"count":count}
+        if fmt=="binary":
+            info["next_cursor"]=self.sq.stream_cursor({**st,"pos":p0+count,"state":None},with_state=False)
+            return info,(np.array(t,dtype="<u8").tobytes() for _,t in it)
+        big=lambda x:x if abs(x).bit_length()<=13000 else self.sq._to_str(x)
+        def gen():
+            t0=time.perf_counter(); n=0
+            for p,t in it:
+                yield (json.dumps({"pos":p,"terms":[big(x) for x in t]},separators=(",",":"))+"\n").encode(); n+=len(t)
+            nxt=self.sq.stream_cursor(st)
+            yield (json.dumps({"done":nxt is None,"count":n,"pos":p0,"next_cursor":nxt,
+                               "latency_us":round((time.perf_counter()-t0)*1e6,4)})+"\n").encode()
+        return info,gen()
+
+    def binomial(self,op,n,k=0,lo=0,hi=None,mod=None,fmt="dec"):
+        return self.bi.compute(op,n,k,lo,hi,mod,fmt)
+
+    async def binomial_batch(self,chunks,mod,fmt="binary",workers=0):
+        """C(n, k) mod m sobre pares (n, k) uint64 no corpo; corpo e lanes passam
+        pelo orçamento NEXUS_MEMORY_MB."""
+        t0=time.perf_counter()
+        try:
+            dec=ArrayDecoder(fmt,"uint64"); a,held=await self._read_body(chunks,dec)
+        except (ValueError,OverflowError) as e: return {"error":str(e)},None
+        try:
+            if len(a)%2: return {"error":"O corpo deve ter pares (n, k)"},None
+            self.budget.reserve(4*a.nbytes); held+=4*a.nbytes      # lanes por potência de primo: ~3x o corpo medido
+            r=await asyncio.to_thread(self.bi.mod_batch,a[0::2],a[1::2],mod,workers)
+        except ValueError as e: return {"error":str(e)},None
+        finally: self.budget.release(held)
+        return {"mod":mod,"count":len(r),"bytes_in":dec.bytes_in,
+                "latency_us":round((time.perf_counter()-t0)*1e6,4)},r.astype("<u8")
+
+    def binomial_triangle(self,r0,r1,mod=None,workers=0):
+        """Linhas r0..r1 do triângulo de Pascal em NDJSON ({"n", "row"} por
+        linha); a última linha traz count e latência."""
+        it=self.bi.triangle(r0,r1,mod,workers)
+        try: first=next(it)
+        except ValueError as e: return {"error":str(e)},None
+        def gen():
+            t0=time.perf_counter(); n=0
+            for i,row in itertools.chain([first],it):
+                yield (json.dumps({"n":i,"row":row if isinstance(row,list) else row.tolist()},separators=(",",":"))+"\n").encode()
+                n+=1
+            yield (json.dumps({"done":True,"count":n,"r0":r0,"r1":r1,"mod":mod,
+                               "latency_us":round((time.perf_counter()-t0)*1e6,4)})+"\n").encode()
+        return {"r0":r0,"r1":r1},gen()
+
+    # ── Estatística ─────────────────────────────────────────────────────────
+    # NEXUS_STATS_MEMORY_MB: orçamento compartilhado pelos jobs de analyze. Um
+    # job reserva 2 bytes por byte de dado (o array e a cópia da seleção).
+    def stats_analyze(self,data,workers=0):
+        need=16*len(data)
+        try: self.stats_budget.reserve(need)
+        except ValueError as e: return {"error":str(e)}
+        try: return self.st.analyze(data,workers)
+        finally: self.stats_budget.release(need)
+
+    async def stats_stream(self,chunks,fmt="binary",dtype="float64",workers=0):
+        """analyze sobre um corpo em streaming; cada bloco decodificado é
+        reservado no orçamento antes de ser guardado."""
+        try: dec=ArrayDecoder(fmt,dtype)
+        except Exception as e: return {"error":str(e)}
+        parts=[]; held=0
+        try:
+            try:
+                async for b in chunks:
+                    a=dec.feed(b); self.stats_budget.reserve(2*a.nbytes); held+=2*a.nbytes; parts.append(a)
+                a=dec.close(); self.stats_budget.reserve(2*a.nbytes); held+=2*a.nbytes; parts.append(a)
+            except (ValueError,OverflowError) as e: return {"error":str(e)}
+            arr=np.concatenate(parts) if len(parts)>1 else parts[0]; parts.clear()
+            r=await asyncio.to_thread(self.st.analyze,arr,workers)
+        finally: self.stats_budget.release(held)
+        if "error" not in r: r.update(bytes_in=dec.bytes_in,dtype=dtype)
+        return r
 
-    def stats_analyze(self,data):   return self.st.analyze(data)
     def stats_correlation(self,x,y):return self.st.correlation(x,y)
     def stats_histogram(self,data,bins):return self.st.histogram(data,bins)
 